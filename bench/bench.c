@@ -0,0 +1,479 @@
+#define  _GNU_SOURCE
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * Runs the solver binary several times on each instance, records wall time, search statistics and
+ * peak RSS, writes them as CSV and JSON and compares median times with a baseline CSV of an earlier run.
+ * Exits with failure, if some answer is wrong or some instance got slower than the threshold.
+ * Usage: bench [options] path/to/dpll instance...
+ */
+
+#define DEFAULT_RUNS_NUM   3
+#define DEFAULT_TIME_LIMIT 60.0 // Seconds, passed to the solver, which answers UNKNOWN after it
+#define DEFAULT_THRESHOLD  10.0 // Percent of baseline median time
+#define DEFAULT_MIN_TIME   0.05 // Seconds, instances faster both in the baseline and now are too noisy to be compared
+#define MAX_SOLVER_ARGS    64
+#define CSV_HEADER         "instance,expected,result,runs,median_seconds,min_seconds,max_seconds,decisions,propagations,conflicts,peak_rss_kb"
+
+typedef struct BenchOptions {
+    size_t runs_num;
+    double time_limit;
+    double threshold;
+    double min_time;
+    const char* csv_path;
+    const char* json_path;
+    const char* baseline_path;
+    char* solver_args[MAX_SOLVER_ARGS];
+    size_t solver_args_num;
+} BenchOptions;
+
+typedef struct Measurement {
+    const char* instance;
+    const char* expected;   // SAT, UNSAT or ? (unknown)
+    char result[16];        // Answer of the last run, or ERROR if any run failed or runs disagreed
+    double* times;          // Wall time of each run, sorted
+    size_t decisions;       // Search statistics of the last run
+    size_t propagations;
+    size_t conflicts;
+    long peak_rss_kb;       // Max over runs
+    double baseline_median; // Negative, if the instance is not in the baseline
+    bool is_wrong;
+    bool is_slower;
+} Measurement;
+
+typedef struct Baseline {
+    char** instances;
+    double* medians;
+    size_t len;
+} Baseline;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+static int compare_doubles(const void* lhs, const void* rhs) {
+    double left = *(const double*) lhs;
+    double right = *(const double*) rhs;
+    return left < right ? -1 : (left > right ? 1 : 0);
+}
+
+static double median(const Measurement* measurement, size_t runs_num) {
+    const double* times = measurement->times;
+    return runs_num % 2 == 1 ? times[runs_num / 2] : (times[runs_num / 2 - 1] + times[runs_num / 2]) / 2.0;
+}
+
+/**
+ * Expected answer is known for test groups and for generated families, which are SAT or UNSAT by construction.
+ */
+static const char* expected_result(const char* path) {
+    const char* name = strrchr(path, '/');
+    name = name != NULL ? name + 1 : path;
+    if (strstr(path, "/unsat/") != NULL || strncmp(name, "pigeonhole-", 11) == 0 || strncmp(name, "parity-unsat-", 13) == 0) {
+        return "UNSAT";
+    }
+    if (strstr(path, "/sat/") != NULL || strncmp(name, "parity-sat-", 11) == 0) {
+        return "SAT";
+    }
+    return "?";
+}
+
+static char* read_file(const char* path) {
+    FILE* fp = fopen(path, "r");
+    if (fp == NULL) {
+        return NULL;
+    }
+    size_t len = 0;
+    size_t capacity = 4096;
+    char* data = (char*) malloc(capacity);
+    size_t read_len = 0;
+    while (data != NULL && (read_len = fread(data + len, 1, capacity - len - 1, fp)) > 0) {
+        len += read_len;
+        if (len + 1 == capacity) {
+            capacity *= 2;
+            char* grown = (char*) realloc(data, capacity);
+            if (grown == NULL) {
+                free(data);
+            }
+            data = grown;
+        }
+    }
+    fclose(fp);
+    if (data != NULL) {
+        data[len] = '\0';
+    }
+    return data;
+}
+
+/**
+ * Reads unsigned integer field of the stats JSON written by the solver (0 if there is no such field).
+ */
+static size_t json_size(const char* json, const char* key) {
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\": ", key);
+    const char* value = strstr(json, pattern);
+    return value != NULL ? (size_t) strtoull(value + strlen(pattern), NULL, 10) : 0;
+}
+
+static void json_string(const char* json, const char* key, char* value, size_t capacity) {
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\": \"", key);
+    const char* start = strstr(json, pattern);
+    value[0] = '\0';
+    if (start != NULL) {
+        start += strlen(pattern);
+        size_t len = strcspn(start, "\"");
+        len = len < capacity - 1 ? len : capacity - 1;
+        memcpy(value, start, len);
+        value[len] = '\0';
+    }
+}
+
+/**
+ * Runs the solver once, storing its wall time, peak RSS and answer with statistics (from the stats JSON).
+ * Returns -1, if it could not be run or exited with error.
+ */
+static int run_solver(const BenchOptions* options, const char* solver_path, const char* instance, const char* stats_path,
+                      Measurement* measurement, size_t run) {
+    char time_limit_arg[64];
+    char stats_arg[4096];
+    snprintf(time_limit_arg, sizeof(time_limit_arg), "--time-limit=%g", options->time_limit);
+    snprintf(stats_arg, sizeof(stats_arg), "--stats-json=%s", stats_path);
+    char* argv[MAX_SOLVER_ARGS + 5];
+    size_t argc = 0;
+    argv[argc++] = (char*) solver_path;
+    for (size_t i = 0; i < options->solver_args_num; ++i) {
+        argv[argc++] = options->solver_args[i];
+    }
+    argv[argc++] = time_limit_arg;
+    argv[argc++] = stats_arg;
+    argv[argc++] = (char*) instance;
+    argv[argc] = NULL;
+
+    unlink(stats_path);
+    double start = now_seconds();
+    pid_t pid = fork();
+    if (pid < 0) {
+        return -1;
+    }
+    if (pid == 0) {
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (null_fd >= 0) {
+            dup2(null_fd, STDOUT_FILENO);
+            close(null_fd);
+        }
+        execv(solver_path, argv);
+        _exit(127);
+    }
+    int status = 0;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) < 0) {
+        return -1;
+    }
+    measurement->times[run] = now_seconds() - start;
+    measurement->peak_rss_kb = usage.ru_maxrss > measurement->peak_rss_kb ? usage.ru_maxrss : measurement->peak_rss_kb;
+    // UNKNOWN answer (time limit) exits with 2
+    if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0 && WEXITSTATUS(status) != 2)) {
+        return -1;
+    }
+
+    char* json = read_file(stats_path);
+    if (json == NULL) {
+        return -1;
+    }
+    char result[16];
+    json_string(json, "result", result, sizeof(result));
+    measurement->decisions = json_size(json, "decisions");
+    measurement->propagations = json_size(json, "propagations");
+    measurement->conflicts = json_size(json, "conflicts");
+    free(json);
+    if (run > 0 && strcmp(result, measurement->result) != 0) {
+        fprintf(stderr, "%s: run %zu answered %s, but run 0 answered %s\n", instance, run, result, measurement->result);
+        return -1;
+    }
+    memcpy(measurement->result, result, sizeof(result));
+    return 0;
+}
+
+static char* next_csv_field(char** line) {
+    char* field = *line;
+    char* comma = strchr(field, ',');
+    if (comma != NULL) {
+        *comma = '\0';
+        *line = comma + 1;
+    } else {
+        *line = field + strlen(field);
+    }
+    return field;
+}
+
+/**
+ * Reads instances and median times of CSV written by an earlier run. Returns -1, if the file does not exist.
+ */
+static int read_baseline(const char* path, Baseline* baseline) {
+    char* data = read_file(path);
+    if (data == NULL) {
+        return -1;
+    }
+    size_t lines_num = 1;
+    for (const char* c = data; *c != '\0'; ++c) {
+        lines_num += *c == '\n' ? 1 : 0;
+    }
+    baseline->instances = (char**) calloc(lines_num, sizeof(char*));
+    baseline->medians = (double*) calloc(lines_num, sizeof(double));
+    baseline->len = 0;
+    if (baseline->instances == NULL || baseline->medians == NULL) {
+        free(data);
+        return -1;
+    }
+    char* save = NULL;
+    for (char* line = strtok_r(data, "\n", &save); line != NULL; line = strtok_r(NULL, "\n", &save)) {
+        if (strncmp(line, "instance,", 9) == 0) {
+            continue;
+        }
+        char* rest = line;
+        char* instance = next_csv_field(&rest);
+        for (size_t i = 0; i < 3; ++i) {
+            next_csv_field(&rest); // expected, result, runs
+        }
+        char* median_field = next_csv_field(&rest);
+        baseline->instances[baseline->len] = strdup(instance);
+        baseline->medians[baseline->len] = strtod(median_field, NULL);
+        if (baseline->instances[baseline->len] != NULL) {
+            ++baseline->len;
+        }
+    }
+    free(data);
+    return 0;
+}
+
+static double baseline_median(const Baseline* baseline, const char* instance) {
+    for (size_t i = 0; i < baseline->len; ++i) {
+        if (strcmp(baseline->instances[i], instance) == 0) {
+            return baseline->medians[i];
+        }
+    }
+    return -1.0;
+}
+
+static void free_baseline(Baseline* baseline) {
+    for (size_t i = 0; i < baseline->len; ++i) {
+        free(baseline->instances[i]);
+    }
+    free(baseline->instances);
+    free(baseline->medians);
+}
+
+static int write_csv(const char* path, const Measurement* measurements, size_t len, size_t runs_num) {
+    FILE* fp = fopen(path, "w");
+    if (fp == NULL) {
+        return -1;
+    }
+    fprintf(fp, "%s\n", CSV_HEADER);
+    for (size_t i = 0; i < len; ++i) {
+        const Measurement* m = &measurements[i];
+        fprintf(fp, "%s,%s,%s,%zu,%.6f,%.6f,%.6f,%zu,%zu,%zu,%ld\n", m->instance, m->expected, m->result, runs_num,
+                median(m, runs_num), m->times[0], m->times[runs_num - 1], m->decisions, m->propagations, m->conflicts,
+                m->peak_rss_kb);
+    }
+    return fclose(fp);
+}
+
+static int write_json(const char* path, const Measurement* measurements, size_t len, size_t runs_num) {
+    FILE* fp = fopen(path, "w");
+    if (fp == NULL) {
+        return -1;
+    }
+    fprintf(fp, "[\n");
+    for (size_t i = 0; i < len; ++i) {
+        const Measurement* m = &measurements[i];
+        fprintf(fp, "  {\"instance\": \"%s\", \"expected\": \"%s\", \"result\": \"%s\", \"runs\": %zu, ",
+                m->instance, m->expected, m->result, runs_num);
+        fprintf(fp, "\"median_seconds\": %.6f, \"min_seconds\": %.6f, \"max_seconds\": %.6f, ",
+                median(m, runs_num), m->times[0], m->times[runs_num - 1]);
+        fprintf(fp, "\"decisions\": %zu, \"propagations\": %zu, \"conflicts\": %zu, \"peak_rss_kb\": %ld",
+                m->decisions, m->propagations, m->conflicts, m->peak_rss_kb);
+        if (m->baseline_median >= 0.0) {
+            fprintf(fp, ", \"baseline_median_seconds\": %.6f, \"slower\": %s", m->baseline_median, m->is_slower ? "true" : "false");
+        }
+        fprintf(fp, "}%s\n", i + 1 < len ? "," : "");
+    }
+    fprintf(fp, "]\n");
+    return fclose(fp);
+}
+
+static void print_usage(const char* program_name) {
+    fprintf(stderr, "Usage: %s [options] path/to/dpll instance...\n", program_name);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  --runs=N              runs of each instance (default: %d)\n", DEFAULT_RUNS_NUM);
+    fprintf(stderr, "  --time-limit=SECONDS  time limit of each run (default: %g)\n", DEFAULT_TIME_LIMIT);
+    fprintf(stderr, "  --solver-args=ARGS    space separated options of the solver\n");
+    fprintf(stderr, "  --csv=FILE            write results as CSV\n");
+    fprintf(stderr, "  --json=FILE           write results as JSON array\n");
+    fprintf(stderr, "  --baseline=FILE       compare median times with CSV of an earlier run\n");
+    fprintf(stderr, "  --threshold=PERCENT   slowdown, which fails comparison (default: %g)\n", DEFAULT_THRESHOLD);
+    fprintf(stderr, "  --min-time=SECONDS    instances faster than it in both runs are not compared (default: %g)\n", DEFAULT_MIN_TIME);
+}
+
+static int parse_options(int argc, char* argv[], BenchOptions* options) {
+    static const struct option long_options[] = {
+        {"runs",        required_argument, NULL, 'r'},
+        {"time-limit",  required_argument, NULL, 't'},
+        {"solver-args", required_argument, NULL, 'a'},
+        {"csv",         required_argument, NULL, 'c'},
+        {"json",        required_argument, NULL, 'j'},
+        {"baseline",    required_argument, NULL, 'b'},
+        {"threshold",   required_argument, NULL, 'p'},
+        {"min-time",    required_argument, NULL, 'm'},
+        {NULL,          0,                 NULL, 0},
+    };
+
+    int option = 0;
+    char* save = NULL;
+    while ((option = getopt_long(argc, argv, "", long_options, NULL)) != -1) {
+        switch (option) {
+            case 'r':
+                options->runs_num = strtoul(optarg, NULL, 10);
+                if (options->runs_num == 0) {
+                    fprintf(stderr, "Expected positive number of runs, but got '%s'\n", optarg);
+                    return -1;
+                }
+                break;
+            case 't':
+                options->time_limit = strtod(optarg, NULL);
+                break;
+            case 'a':
+                for (char* arg = strtok_r(optarg, " ", &save); arg != NULL; arg = strtok_r(NULL, " ", &save)) {
+                    if (options->solver_args_num == MAX_SOLVER_ARGS) {
+                        fprintf(stderr, "Too many solver options\n");
+                        return -1;
+                    }
+                    options->solver_args[options->solver_args_num++] = arg;
+                }
+                break;
+            case 'c':
+                options->csv_path = optarg;
+                break;
+            case 'j':
+                options->json_path = optarg;
+                break;
+            case 'b':
+                options->baseline_path = optarg;
+                break;
+            case 'p':
+                options->threshold = strtod(optarg, NULL);
+                break;
+            case 'm':
+                options->min_time = strtod(optarg, NULL);
+                break;
+            default:
+                return -1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options = {
+        .runs_num = DEFAULT_RUNS_NUM,
+        .time_limit = DEFAULT_TIME_LIMIT,
+        .threshold = DEFAULT_THRESHOLD,
+        .min_time = DEFAULT_MIN_TIME,
+    };
+    if (parse_options(argc, argv, &options) != 0 || argc - optind < 2) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char* solver_path = argv[optind];
+    size_t instances_num = (size_t) (argc - optind - 1);
+
+    Baseline baseline = {0};
+    bool has_baseline = false;
+    if (options.baseline_path != NULL) {
+        has_baseline = read_baseline(options.baseline_path, &baseline) == 0;
+        if (!has_baseline) {
+            printf("No baseline at '%s', times are not compared\n", options.baseline_path);
+        }
+    }
+
+    char stats_path[] = "/tmp/bench-stats-XXXXXX";
+    int fd = mkstemp(stats_path);
+    Measurement* measurements = (Measurement*) calloc(instances_num, sizeof(Measurement));
+    if (fd < 0 || measurements == NULL) {
+        fprintf(stderr, "Failed to create temporary file\n");
+        return EXIT_FAILURE;
+    }
+    close(fd);
+
+    size_t wrong_num = 0;
+    size_t slower_num = 0;
+    printf("%-48s %-7s %10s %10s %10s %10s %9s %10s\n", "instance", "result", "median s", "min s", "max s",
+           "conflicts", "RSS MB", "baseline");
+    for (size_t i = 0; i < instances_num; ++i) {
+        Measurement* m = &measurements[i];
+        m->instance = argv[optind + 1 + i];
+        m->expected = expected_result(m->instance);
+        m->times = (double*) calloc(options.runs_num, sizeof(double));
+        if (m->times == NULL) {
+            fprintf(stderr, "Insufficient memory\n");
+            return EXIT_FAILURE;
+        }
+        for (size_t run = 0; run < options.runs_num; ++run) {
+            if (run_solver(&options, solver_path, m->instance, stats_path, m, run) != 0) {
+                strcpy(m->result, "ERROR");
+                break;
+            }
+        }
+        qsort(m->times, options.runs_num, sizeof(double), compare_doubles);
+        m->is_wrong = strcmp(m->result, "ERROR") == 0
+            || (strcmp(m->expected, "?") != 0 && strcmp(m->result, "UNKNOWN") != 0 && strcmp(m->result, m->expected) != 0);
+        m->baseline_median = has_baseline ? baseline_median(&baseline, m->instance) : -1.0;
+        double median_time = median(m, options.runs_num);
+        // Noise filter takes the slower time, so an instance, that was fast in the baseline, still fails once it is slow
+        m->is_slower = m->baseline_median >= 0.0
+            && (m->baseline_median > median_time ? m->baseline_median : median_time) >= options.min_time
+            && median_time > m->baseline_median * (1.0 + options.threshold / 100.0);
+        wrong_num += m->is_wrong ? 1 : 0;
+        slower_num += m->is_slower ? 1 : 0;
+
+        printf("%-48s %-7s %10.3f %10.3f %10.3f %10zu %9.1f", m->instance, m->result, median_time, m->times[0],
+               m->times[options.runs_num - 1], m->conflicts, (double) m->peak_rss_kb / 1024.0);
+        if (m->baseline_median >= 0.0) {
+            printf(" %10.3f %+6.1f%%", m->baseline_median, 100.0 * (median_time / m->baseline_median - 1.0));
+        }
+        printf("%s%s\n", m->is_wrong ? "  WRONG" : "", m->is_slower ? "  SLOWER" : "");
+        fflush(stdout);
+    }
+    unlink(stats_path);
+
+    int exit_code = EXIT_SUCCESS;
+    if (options.csv_path != NULL && write_csv(options.csv_path, measurements, instances_num, options.runs_num) != 0) {
+        fprintf(stderr, "Failed to write '%s'\n", options.csv_path);
+        exit_code = EXIT_FAILURE;
+    }
+    if (options.json_path != NULL && write_json(options.json_path, measurements, instances_num, options.runs_num) != 0) {
+        fprintf(stderr, "Failed to write '%s'\n", options.json_path);
+        exit_code = EXIT_FAILURE;
+    }
+    if (wrong_num > 0 || slower_num > 0) {
+        printf("%zu wrong answers, %zu instances slower than baseline by more than %g%%\n", wrong_num, slower_num, options.threshold);
+        exit_code = EXIT_FAILURE;
+    }
+
+    for (size_t i = 0; i < instances_num; ++i) {
+        free(measurements[i].times);
+    }
+    free(measurements);
+    free_baseline(&baseline);
+    return exit_code;
+}
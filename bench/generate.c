@@ -0,0 +1,239 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Writes generated benchmark families into the given directory, the same files for every run:
+ * random 3-SAT near the satisfiability threshold, random 3-SAT with each var split into a cycle of equivalent
+ * copies, pigeonhole formulas and parity chains.
+ * Usage: generate out_dir
+ */
+
+#define RANDOM_3SAT_RATIO 4.26 // Clauses per var, where random 3-SAT is the hardest
+#define RANDOM_3SAT_SEEDS 3
+#define EQUIVALENT_COPIES 8    // Copies of each var of random 3-SAT with equivalent vars
+
+static const size_t random_3sat_vars[] = {100, 150, 200};
+static const size_t equivalent_3sat_vars[] = {100, 150};
+static const size_t pigeonhole_holes[] = {5, 6, 7, 8};
+static const size_t parity_vars[] = {12, 16, 20, 22};
+
+static uint64_t next_random(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static FILE* open_instance(const char* dir, const char* name) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s.cnf", dir, name);
+    FILE* fp = fopen(path, "w");
+    if (fp == NULL) {
+        fprintf(stderr, "Failed to create '%s'\n", path);
+    }
+    return fp;
+}
+
+static int write_random_3sat(const char* dir, size_t vars_num, uint64_t seed) {
+    char name[256];
+    snprintf(name, sizeof(name), "random-3sat-%zu-%llu", vars_num, (unsigned long long) seed);
+    FILE* fp = open_instance(dir, name);
+    if (fp == NULL) {
+        return -1;
+    }
+    size_t clauses_num = (size_t) (RANDOM_3SAT_RATIO * (double) vars_num + 0.5);
+    uint64_t state = 0x9E3779B97F4A7C15ULL * (seed + 1) + vars_num;
+    fprintf(fp, "c random 3-SAT, %zu vars, ratio %.2f, seed %llu\n", vars_num, RANDOM_3SAT_RATIO, (unsigned long long) seed);
+    fprintf(fp, "p cnf %zu %zu\n", vars_num, clauses_num);
+    for (size_t i = 0; i < clauses_num; ++i) {
+        size_t vars[3] = {0};
+        for (size_t j = 0; j < 3; ++j) {
+            // Vars of a clause are distinct
+            bool is_duplicate = true;
+            while (is_duplicate) {
+                vars[j] = (size_t) (next_random(&state) % vars_num) + 1;
+                is_duplicate = false;
+                for (size_t k = 0; k < j; ++k) {
+                    is_duplicate = is_duplicate || vars[k] == vars[j];
+                }
+            }
+            fprintf(fp, "%s%zu ", next_random(&state) % 2 == 0 ? "" : "-", vars[j]);
+        }
+        fprintf(fp, "0\n");
+    }
+    return fclose(fp);
+}
+
+/**
+ * Random 3-SAT, where each var has EQUIVALENT_COPIES copies tied by a cycle of binary implications (half of them
+ * negated), and each literal of a clause uses a random copy, like chains of equivalent vars of circuit encodings.
+ */
+static int write_equivalent_3sat(const char* dir, size_t vars_num, uint64_t seed) {
+    char name[256];
+    snprintf(name, sizeof(name), "equivalent-3sat-%zu-%llu", vars_num, (unsigned long long) seed);
+    FILE* fp = open_instance(dir, name);
+    if (fp == NULL) {
+        return -1;
+    }
+    size_t clauses_num = (size_t) (RANDOM_3SAT_RATIO * (double) vars_num + 0.5);
+    uint64_t state = 0x9E3779B97F4A7C15ULL * (seed + 1) + vars_num;
+    fprintf(fp, "c random 3-SAT, %zu vars with %d equivalent copies each, ratio %.2f, seed %llu\n",
+            vars_num, EQUIVALENT_COPIES, RANDOM_3SAT_RATIO, (unsigned long long) seed);
+    fprintf(fp, "p cnf %zu %zu\n", vars_num * EQUIVALENT_COPIES, clauses_num + vars_num * EQUIVALENT_COPIES);
+    // Copy j of var i is var i * EQUIVALENT_COPIES + j + 1, odd copies are equal to the negation of the var
+    for (size_t i = 0; i < vars_num; ++i) {
+        for (size_t j = 0; j < EQUIVALENT_COPIES; ++j) {
+            size_t next = (j + 1) % EQUIVALENT_COPIES;
+            fprintf(fp, "%s%zu %s%zu 0\n", j % 2 == 0 ? "-" : "", i * EQUIVALENT_COPIES + j + 1,
+                    next % 2 == 0 ? "" : "-", i * EQUIVALENT_COPIES + next + 1);
+        }
+    }
+    for (size_t i = 0; i < clauses_num; ++i) {
+        size_t vars[3] = {0};
+        for (size_t j = 0; j < 3; ++j) {
+            bool is_duplicate = true;
+            while (is_duplicate) {
+                vars[j] = (size_t) (next_random(&state) % vars_num);
+                is_duplicate = false;
+                for (size_t k = 0; k < j; ++k) {
+                    is_duplicate = is_duplicate || vars[k] == vars[j];
+                }
+            }
+            size_t copy = (size_t) (next_random(&state) % EQUIVALENT_COPIES);
+            bool is_negated = (next_random(&state) % 2 == 0) != (copy % 2 == 0);
+            fprintf(fp, "%s%zu ", is_negated ? "-" : "", vars[j] * EQUIVALENT_COPIES + copy + 1);
+        }
+        fprintf(fp, "0\n");
+    }
+    return fclose(fp);
+}
+
+/**
+ * Holes + 1 pigeons in the given number of holes, which is UNSAT and hard for resolution.
+ */
+static int write_pigeonhole(const char* dir, size_t holes_num) {
+    char name[256];
+    snprintf(name, sizeof(name), "pigeonhole-%zu", holes_num);
+    FILE* fp = open_instance(dir, name);
+    if (fp == NULL) {
+        return -1;
+    }
+    size_t pigeons_num = holes_num + 1;
+    size_t clauses_num = pigeons_num + holes_num * pigeons_num * (pigeons_num - 1) / 2;
+    fprintf(fp, "c pigeonhole, %zu pigeons in %zu holes\n", pigeons_num, holes_num);
+    fprintf(fp, "p cnf %zu %zu\n", pigeons_num * holes_num, clauses_num);
+    // Var of pigeon i in hole j is i * holes_num + j + 1
+    for (size_t i = 0; i < pigeons_num; ++i) {
+        for (size_t j = 0; j < holes_num; ++j) {
+            fprintf(fp, "%zu ", i * holes_num + j + 1);
+        }
+        fprintf(fp, "0\n");
+    }
+    for (size_t j = 0; j < holes_num; ++j) {
+        for (size_t i = 0; i < pigeons_num; ++i) {
+            for (size_t k = i + 1; k < pigeons_num; ++k) {
+                fprintf(fp, "-%zu -%zu 0\n", i * holes_num + j + 1, k * holes_num + j + 1);
+            }
+        }
+    }
+    return fclose(fp);
+}
+
+static void shuffle(size_t* items, size_t len, uint64_t* state) {
+    for (size_t i = len; i > 1; --i) {
+        size_t j = (size_t) (next_random(state) % i);
+        size_t item = items[i - 1];
+        items[i - 1] = items[j];
+        items[j] = item;
+    }
+}
+
+/**
+ * Writes clauses of y = p xor q.
+ */
+static void write_xor(FILE* fp, size_t y, size_t p, size_t q) {
+    fprintf(fp, "-%zu %zu %zu 0\n", y, p, q);
+    fprintf(fp, "-%zu -%zu -%zu 0\n", y, p, q);
+    fprintf(fp, "%zu -%zu %zu 0\n", y, p, q);
+    fprintf(fp, "%zu %zu -%zu 0\n", y, p, q);
+}
+
+/**
+ * Writes a chain of xors over vars in the given order, which starts with var first_chain_var,
+ * and returns the var equal to xor of them all.
+ */
+static size_t write_parity_chain(FILE* fp, const size_t* order, size_t vars_num, size_t first_chain_var) {
+    size_t parity = order[0];
+    for (size_t i = 1; i < vars_num; ++i) {
+        size_t chain_var = first_chain_var + i - 1;
+        write_xor(fp, chain_var, parity, order[i]);
+        parity = chain_var;
+    }
+    return parity;
+}
+
+/**
+ * Two parity chains over the same vars in different random orders. Instance is SAT, if both chains
+ * are required to be odd, and UNSAT, if one of them is required to be even (resolution needs to
+ * relate the two orders, which is hard).
+ */
+static int write_parity(const char* dir, size_t vars_num, bool is_sat) {
+    char name[256];
+    snprintf(name, sizeof(name), "parity-%s-%zu", is_sat ? "sat" : "unsat", vars_num);
+    FILE* fp = open_instance(dir, name);
+    size_t* order = (size_t*) malloc(vars_num * sizeof(size_t));
+    if (fp == NULL || order == NULL) {
+        free(order);
+        if (fp != NULL) {
+            fclose(fp);
+        }
+        return -1;
+    }
+    uint64_t state = 0xD1B54A32D192ED03ULL + vars_num;
+    size_t chain_vars_num = vars_num - 1;
+    fprintf(fp, "c two parity chains over %zu vars, %s\n", vars_num, is_sat ? "both odd" : "odd and even");
+    fprintf(fp, "p cnf %zu %zu\n", vars_num + 2 * chain_vars_num, 8 * chain_vars_num + 2);
+    for (size_t i = 0; i < vars_num; ++i) {
+        order[i] = i + 1;
+    }
+    shuffle(order, vars_num, &state);
+    size_t first_parity = write_parity_chain(fp, order, vars_num, vars_num + 1);
+    shuffle(order, vars_num, &state);
+    size_t second_parity = write_parity_chain(fp, order, vars_num, vars_num + chain_vars_num + 1);
+    fprintf(fp, "%zu 0\n", first_parity);
+    fprintf(fp, "%s%zu 0\n", is_sat ? "" : "-", second_parity);
+    free(order);
+    return fclose(fp);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s out_dir\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char* dir = argv[1];
+    int status = 0;
+    for (size_t i = 0; i < sizeof(random_3sat_vars) / sizeof(random_3sat_vars[0]); ++i) {
+        for (uint64_t seed = 1; seed <= RANDOM_3SAT_SEEDS; ++seed) {
+            status |= write_random_3sat(dir, random_3sat_vars[i], seed);
+        }
+    }
+    for (size_t i = 0; i < sizeof(equivalent_3sat_vars) / sizeof(equivalent_3sat_vars[0]); ++i) {
+        for (uint64_t seed = 1; seed <= RANDOM_3SAT_SEEDS; ++seed) {
+            status |= write_equivalent_3sat(dir, equivalent_3sat_vars[i], seed);
+        }
+    }
+    for (size_t i = 0; i < sizeof(pigeonhole_holes) / sizeof(pigeonhole_holes[0]); ++i) {
+        status |= write_pigeonhole(dir, pigeonhole_holes[i]);
+    }
+    for (size_t i = 0; i < sizeof(parity_vars) / sizeof(parity_vars[0]); ++i) {
+        status |= write_parity(dir, parity_vars[i], true);
+        status |= write_parity(dir, parity_vars[i], false);
+    }
+    return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,227 @@
+#define  _GNU_SOURCE
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "cnf.h"
+#include "ipasir.h"
+
+/**
+ * Per-query latency of the same queries (random assumptions over the CNF) answered by one incremental
+ * library solver and by spawning the solver binary for a CNF with the assumptions as unit clauses.
+ * Usage: ipasir-latency path/to/dpll input.cnf [queries_num] [assumptions_num]
+ */
+
+#define DEFAULT_QUERIES_NUM     200
+#define DEFAULT_ASSUMPTIONS_NUM 3
+
+typedef struct Query {
+    signed int* assumptions;
+    int expected; // Answer of the library (10 or 20)
+} Query;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+static uint64_t next_random(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static int compare_doubles(const void* lhs, const void* rhs) {
+    double left = *(const double*) lhs;
+    double right = *(const double*) rhs;
+    return left < right ? -1 : (left > right ? 1 : 0);
+}
+
+static void print_latencies(const char* name, double* latencies, size_t num) {
+    double sum = 0.0;
+    for (size_t i = 0; i < num; ++i) {
+        sum += latencies[i];
+    }
+    qsort(latencies, num, sizeof(double), compare_doubles);
+    printf("%-8s mean %9.3f ms   median %9.3f ms   max %9.3f ms   total %8.3f s\n",
+           name, 1e3 * sum / (double) num, 1e3 * latencies[num / 2], 1e3 * latencies[num - 1], sum);
+}
+
+static int write_query_cnf(const CNF* cnf, const Query* query, size_t assumptions_num, const char* path) {
+    FILE* fp = fopen(path, "w");
+    if (fp == NULL) {
+        return -1;
+    }
+    fprintf(fp, "p cnf %zu %zu\n", cnf->vars_num, cnf->clauses_num + assumptions_num);
+    for (size_t i = 0; i < cnf->clauses_num; ++i) {
+        const Clause* clause = &cnf->clauses[i];
+        const signed int* vars = cnf_clause_vars(cnf, clause);
+        for (size_t j = 0; j < clause->len; ++j) {
+            fprintf(fp, "%d ", vars[j]);
+        }
+        fprintf(fp, "0\n");
+    }
+    for (size_t i = 0; i < assumptions_num; ++i) {
+        fprintf(fp, "%d 0\n", query->assumptions[i]);
+    }
+    return fclose(fp);
+}
+
+/**
+ * Runs the solver binary on the file and returns 10 for SAT, 20 for UNSAT and -1 on failure.
+ */
+static int run_solver_process(const char* solver_path, const char* cnf_path) {
+    int pipe_fds[2];
+    if (pipe(pipe_fds) != 0) {
+        return -1;
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        dup2(pipe_fds[1], STDOUT_FILENO);
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        execl(solver_path, solver_path, cnf_path, (char*) NULL);
+        _exit(127);
+    }
+
+    close(pipe_fds[1]);
+    char output[64] = {0};
+    size_t len = 0;
+    ssize_t read_len = 0;
+    while (len + 1 < sizeof(output) && (read_len = read(pipe_fds[0], output + len, sizeof(output) - 1 - len)) > 0) {
+        len += (size_t) read_len;
+    }
+    close(pipe_fds[0]);
+    int status = 0;
+    if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return -1;
+    }
+    if (strcmp(output, "SAT") == 0) {
+        return 10;
+    }
+    if (strcmp(output, "UNSAT") == 0) {
+        return 20;
+    }
+    return -1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3 || argc > 5) {
+        fprintf(stderr, "Usage: %s path/to/dpll input.cnf [queries_num] [assumptions_num]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char* solver_path = argv[1];
+    size_t queries_num = argc > 3 ? strtoul(argv[3], NULL, 10) : DEFAULT_QUERIES_NUM;
+    size_t assumptions_num = argc > 4 ? strtoul(argv[4], NULL, 10) : DEFAULT_ASSUMPTIONS_NUM;
+    FILE* fp = fopen(argv[2], "r");
+    CNF* cnf = fp != NULL ? read_dimacs_cnf(fp) : NULL;
+    if (fp != NULL) {
+        fclose(fp);
+    }
+    if (cnf == NULL || cnf->vars_num == 0 || queries_num == 0) {
+        fprintf(stderr, "Failed to read non-empty CNF from '%s'\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+
+    Query* queries = (Query*) calloc(queries_num, sizeof(Query));
+    double* latencies = (double*) calloc(queries_num, sizeof(double));
+    if (queries == NULL || latencies == NULL) {
+        fprintf(stderr, "Insufficient memory\n");
+        return EXIT_FAILURE;
+    }
+    uint64_t random_state = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < queries_num; ++i) {
+        queries[i].assumptions = (signed int*) calloc(assumptions_num + 1, sizeof(signed int));
+        if (queries[i].assumptions == NULL) {
+            fprintf(stderr, "Insufficient memory\n");
+            return EXIT_FAILURE;
+        }
+        for (size_t j = 0; j < assumptions_num; ++j) {
+            signed int var = (signed int) (next_random(&random_state) % cnf->vars_num) + 1;
+            queries[i].assumptions[j] = next_random(&random_state) % 2 == 0 ? var : -var;
+        }
+    }
+
+    // Library: the CNF is parsed and added once, then each query only sets its assumptions
+    size_t sat_num = 0;
+    double start = now_seconds();
+    void* solver = ipasir_init();
+    for (size_t i = 0; i < cnf->clauses_num; ++i) {
+        const Clause* clause = &cnf->clauses[i];
+        const signed int* vars = cnf_clause_vars(cnf, clause);
+        for (size_t j = 0; j < clause->len; ++j) {
+            ipasir_add(solver, vars[j]);
+        }
+        ipasir_add(solver, 0);
+    }
+    double setup_time = now_seconds() - start;
+    for (size_t i = 0; i < queries_num; ++i) {
+        double query_start = now_seconds();
+        for (size_t j = 0; j < assumptions_num; ++j) {
+            ipasir_assume(solver, queries[i].assumptions[j]);
+        }
+        queries[i].expected = ipasir_solve(solver);
+        latencies[i] = now_seconds() - query_start;
+        sat_num += queries[i].expected == 10 ? 1 : 0;
+        if (queries[i].expected != 10 && queries[i].expected != 20) {
+            fprintf(stderr, "Library failed on query %zu\n", i);
+            return EXIT_FAILURE;
+        }
+    }
+    ipasir_release(solver);
+    printf("%zu queries of %zu assumptions over %zu vars and %zu clauses: %zu SAT, %zu UNSAT\n",
+           queries_num, assumptions_num, cnf->vars_num, cnf->clauses_num, sat_num, queries_num - sat_num);
+    printf("library  adding clauses once %.3f ms\n", 1e3 * setup_time);
+    print_latencies("library", latencies, queries_num);
+
+    // Process: every query is a new CNF file, which is parsed and solved from scratch
+    char path[] = "/tmp/ipasir-latency-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        fprintf(stderr, "Failed to create temporary file\n");
+        return EXIT_FAILURE;
+    }
+    close(fd);
+    int exit_code = EXIT_SUCCESS;
+    for (size_t i = 0; i < queries_num; ++i) {
+        if (write_query_cnf(cnf, &queries[i], assumptions_num, path) != 0) {
+            fprintf(stderr, "Failed to write query CNF\n");
+            exit_code = EXIT_FAILURE;
+            break;
+        }
+        double query_start = now_seconds();
+        int answer = run_solver_process(solver_path, path);
+        latencies[i] = now_seconds() - query_start;
+        if (answer != queries[i].expected) {
+            fprintf(stderr, "Query %zu: process answered %d, but library answered %d\n", i, answer, queries[i].expected);
+            exit_code = EXIT_FAILURE;
+            break;
+        }
+    }
+    unlink(path);
+    if (exit_code == EXIT_SUCCESS) {
+        print_latencies("process", latencies, queries_num);
+    }
+
+    for (size_t i = 0; i < queries_num; ++i) {
+        free(queries[i].assumptions);
+    }
+    free(queries);
+    free(latencies);
+    free_cnf(cnf);
+    return exit_code;
+}
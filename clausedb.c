@@ -0,0 +1,98 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "clausedb.h"
+#include "cnf.h"
+#include "debug.h"
+
+#define CLAUSE_DB_ERROR(msg) do { \
+    fprintf(stderr, "Clause DB Error: " msg "\n"); \
+} while (0)
+
+ClauseDb* create_clausedb(const CNF* cnf) {
+    assert(cnf != NULL);
+
+    ClauseDb* db = (ClauseDb*) calloc(1, sizeof(ClauseDb));
+    if (db == NULL) {
+        CLAUSE_DB_ERROR("Insufficient memory");
+        return NULL;
+    }
+    db->cnf = cnf;
+    return db;
+}
+
+void free_clausedb(ClauseDb* db) {
+    if (db != NULL) {
+        free(db->learnts);
+        free(db->vars);
+        free(db);
+    }
+}
+
+size_t clausedb_add_learnt(ClauseDb* db, const signed int* vars, size_t len, size_t lbd) {
+    assert(db != NULL);
+    assert(vars != NULL);
+
+    if (db->learnts_num == db->learnts_capacity) {
+        size_t new_capacity = db->learnts_capacity == 0 ? 64 : 2 * db->learnts_capacity;
+        LearntClause* new_learnts = (LearntClause*) realloc(db->learnts, new_capacity * sizeof(LearntClause));
+        if (new_learnts == NULL) {
+            CLAUSE_DB_ERROR("Insufficient memory");
+            return NO_CLAUSE;
+        }
+        db->learnts = new_learnts;
+        db->learnts_capacity = new_capacity;
+    }
+    if (db->vars_len + len > db->vars_capacity) {
+        size_t new_capacity = db->vars_capacity == 0 ? 1024 : db->vars_capacity;
+        while (new_capacity < db->vars_len + len) {
+            new_capacity *= 2;
+        }
+        signed int* new_vars = (signed int*) realloc(db->vars, new_capacity * sizeof(signed int));
+        if (new_vars == NULL) {
+            CLAUSE_DB_ERROR("Insufficient memory");
+            return NO_CLAUSE;
+        }
+        db->vars = new_vars;
+        db->vars_capacity = new_capacity;
+    }
+
+    LearntClause* clause = &db->learnts[db->learnts_num++];
+    clause->offset = db->vars_len;
+    clause->len = len;
+    clause->lbd = lbd;
+    clause->activity = 0.0;
+    clause->deleted = false;
+    clause->irredundant = false;
+    memcpy(db->vars + db->vars_len, vars, len * sizeof(signed int));
+    db->vars_len += len;
+    return db->cnf->clauses_num + db->learnts_num - 1;
+}
+
+void clausedb_compact(ClauseDb* db, size_t* relocations) {
+    assert(db != NULL);
+    assert(relocations != NULL);
+
+    LearntClause* learnts = db->learnts;
+    signed int* vars = db->vars;
+    size_t first_learnt_num = db->cnf->clauses_num;
+    size_t kept = 0;
+    size_t vars_len = 0;
+    for (size_t i = 0, learnts_num = db->learnts_num; i < learnts_num; ++i) {
+        if (learnts[i].deleted) {
+            relocations[i] = NO_CLAUSE;
+            continue;
+        }
+        LearntClause clause = learnts[i];
+        // Clauses are moved only to the front, so memmove never overwrites vars that weren't moved yet
+        memmove(vars + vars_len, vars + clause.offset, clause.len * sizeof(signed int));
+        clause.offset = vars_len;
+        vars_len += clause.len;
+        learnts[kept] = clause;
+        relocations[i] = first_learnt_num + kept;
+        ++kept;
+    }
+    db->learnts_num = kept;
+    db->vars_len = vars_len;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include "cnf.h"
+#include "debug.h"
+
+#define NO_CLAUSE ((size_t) -1)
+
+typedef struct LearntClause {
+    size_t offset; // Index of the first var of the clause in vars arena
+    size_t len;
+    size_t lbd;    // Number of distinct decision levels among the vars, when the clause was learned
+    double activity;
+    bool deleted;
+    bool irredundant; // Added to the solver after the CNF rather than learned, so it is never deleted
+} LearntClause;
+
+/**
+ * Clauses available to the solver: clauses of the CNF (read-only, numbered first)
+ * followed by clauses learned during search or added later (stored in own arena).
+ * Learned clauses can be deleted, which renumbers the remaining ones on compaction.
+ */
+typedef struct ClauseDb {
+    const CNF* cnf;
+    LearntClause* learnts;
+    size_t learnts_num;
+    size_t learnts_capacity;
+    signed int* vars; // Vars of learned clauses, stored one clause after another
+    size_t vars_len;
+    size_t vars_capacity;
+} ClauseDb;
+
+ClauseDb* create_clausedb(const CNF* cnf);
+
+void free_clausedb(ClauseDb* db);
+
+static inline size_t clausedb_clauses_num(const ClauseDb* db) {
+    assert(db != NULL);
+
+    return db->cnf->clauses_num + db->learnts_num;
+}
+
+static inline bool clausedb_is_learnt(const ClauseDb* db, size_t clause_num) {
+    assert(db != NULL);
+
+    return clause_num >= db->cnf->clauses_num;
+}
+
+/**
+ * Returns vars of the given clause and stores their count in len.
+ */
+static inline const signed int* clausedb_clause_vars(const ClauseDb* db, size_t clause_num, size_t* len) {
+    assert(db != NULL);
+    assert(len != NULL);
+    assertf(clause_num < clausedb_clauses_num(db), "Expected clause in [0; %zu), but got %zu", clausedb_clauses_num(db), clause_num);
+
+    const CNF* cnf = db->cnf;
+    if (clause_num < cnf->clauses_num) {
+        const Clause* clause = &cnf->clauses[clause_num];
+        *len = clause->len;
+        return cnf->vars + clause->offset;
+    }
+    const LearntClause* clause = &db->learnts[clause_num - cnf->clauses_num];
+    *len = clause->len;
+    return db->vars + clause->offset;
+}
+
+static inline LearntClause* clausedb_learnt(ClauseDb* db, size_t clause_num) {
+    assert(db != NULL);
+    assert(clausedb_is_learnt(db, clause_num));
+    assertf(clause_num < clausedb_clauses_num(db), "Expected clause in [0; %zu), but got %zu", clausedb_clauses_num(db), clause_num);
+
+    return &db->learnts[clause_num - db->cnf->clauses_num];
+}
+
+/**
+ * Copies the given vars as a new learned clause and returns its number (NO_CLAUSE if out of memory).
+ */
+size_t clausedb_add_learnt(ClauseDb* db, const signed int* vars, size_t len, size_t lbd);
+
+/**
+ * Removes deleted learned clauses, moving the remaining ones (and their vars) to the front, so they stay contiguous.
+ * For each learned clause (indexed from zero) stores its new number (or NO_CLAUSE if it was deleted) in relocations.
+ */
+void clausedb_compact(ClauseDb* db, size_t* relocations);
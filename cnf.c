@@ -1,10 +1,17 @@
 #define  _GNU_SOURCE
 #include <assert.h>
+#include <limits.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include "cnf.h"
+#include "decompress.h"
+
+#define SCANNER_CHUNK_SIZE  (1 << 16) // Bytes read at once from files, which cannot be memory-mapped
+#define SCANNER_MAX_INT_LEN 24        // Sign, digits of a number up to LLONG_MAX / 10 and one more digit
 
 #define CLAUSE_PARSE_ERROR(msg) do { \
     fprintf(stderr, "Clause Parse Error: " msg "\n"); \
@@ -22,183 +29,511 @@
     fprintf(stderr, "CNF Parse Error: " fmt "\n", ##__VA_ARGS__); \
 } while (0)
 
-int read_dimacs_clause(char* line, size_t max_vars_num, Clause* clause) {
-    assert(line != NULL);
-    assert(clause != NULL);
+static int reserve_cnf_vars(CNF* cnf, size_t vars_len) {
+    assert(cnf != NULL);
+
+    if (vars_len <= cnf->vars_capacity) {
+        return 0;
+    }
 
-    signed int* vars = (signed int*) calloc(max_vars_num, sizeof(signed int));
-    if (vars == NULL) {
-        CLAUSE_PARSE_ERROR("Insufficient memory");
+    size_t new_capacity = cnf->vars_capacity == 0 ? 16 : cnf->vars_capacity;
+    while (new_capacity < vars_len) {
+        new_capacity *= 2;
+    }
+    signed int* new_vars = (signed int*) realloc(cnf->vars, new_capacity * sizeof(signed int));
+    if (new_vars == NULL) {
         return -1;
     }
+    cnf->vars = new_vars;
+    cnf->vars_capacity = new_capacity;
+    return 0;
+}
 
-    size_t real_vars_num = 0;
-    const char* delims = " \t";
-    char* token = strtok(line, delims);
-    signed int var = 0; 
-    while (token != NULL) {
-        var = atoi(token);
-        token = strtok(NULL, delims);
-        if (var == 0) {
-            break;
+CNF* create_cnf(size_t vars_num, size_t clauses_capacity, size_t vars_capacity) {
+    CNF* cnf = (CNF*) calloc(1, sizeof(CNF));
+    if (cnf == NULL) {
+        return NULL;
+    }
+    cnf->vars_num = vars_num;
+    cnf->clauses = (Clause*) calloc(clauses_capacity + 1, sizeof(Clause));
+    if (cnf->clauses == NULL || reserve_cnf_vars(cnf, vars_capacity) != 0) {
+        free_cnf(cnf);
+        return NULL;
+    }
+    return cnf;
+}
+
+int cnf_add_clause(CNF* cnf, const signed int* vars, size_t len) {
+    assert(cnf != NULL);
+    assert(cnf->clauses != NULL);
+    assert(vars != NULL || len == 0);
+
+    if (reserve_cnf_vars(cnf, cnf->vars_len + len) != 0) {
+        return -1;
+    }
+    Clause* clause = &cnf->clauses[cnf->clauses_num++];
+    clause->offset = cnf->vars_len;
+    clause->len = len;
+    if (len > 0) {
+        memcpy(cnf->vars + cnf->vars_len, vars, len * sizeof(signed int));
+        cnf->vars_len += len;
+    }
+    return 0;
+}
+
+bool cnf_is_satisfied_by(const CNF* cnf, const bool* model) {
+    assert(cnf != NULL);
+    assert(model != NULL);
+
+    for (size_t clause_num = 0; clause_num < cnf->clauses_num; ++clause_num) {
+        const Clause* clause = &cnf->clauses[clause_num];
+        const signed int* vars = cnf_clause_vars(cnf, clause);
+        bool is_satisfied = false;
+        for (size_t var_num = 0; var_num < clause->len && !is_satisfied; ++var_num) {
+            signed int var = vars[var_num];
+            is_satisfied = model[(var > 0 ? var : -var) - 1] == (var > 0);
+        }
+        if (!is_satisfied) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * First pass counts occurances, second one fills them.
+ */
+void build_occurances(const void* clauses, size_t clauses_num, ClauseVarsGetter clause_vars, size_t lits_num,
+                      size_t* starts, size_t* occurances) {
+    assert(clause_vars != NULL);
+    assert(starts != NULL);
+    assert(occurances != NULL || clauses_num == 0);
+
+    memset(starts, 0, (lits_num + 1) * sizeof(size_t));
+    for (size_t clause_num = 0; clause_num < clauses_num; ++clause_num) {
+        size_t len = 0;
+        const signed int* vars = clause_vars(clauses, clause_num, &len);
+        for (size_t var_num = 0; var_num < len; ++var_num) {
+            ++starts[cnf_lit_index(vars[var_num]) + 1];
         }
-        if ((var > 0 && var > max_vars_num) || (var < 0 && -var > max_vars_num)) {
-            CLAUSE_PARSE_ERROR_F("Expected variables in [-%zu; %zu], but got %d", max_vars_num, max_vars_num, var);
-            free(vars);
+    }
+    for (size_t i = 0; i < lits_num; ++i) {
+        starts[i + 1] += starts[i];
+    }
+
+    // starts[i] is used as a fill position of i-th group, so it ends up pointing at the end of the group
+    for (size_t clause_num = 0; clause_num < clauses_num; ++clause_num) {
+        size_t len = 0;
+        const signed int* vars = clause_vars(clauses, clause_num, &len);
+        for (size_t var_num = 0; var_num < len; ++var_num) {
+            occurances[starts[cnf_lit_index(vars[var_num])]++] = clause_num;
+        }
+    }
+    for (size_t i = lits_num; i > 0; --i) {
+        starts[i] = starts[i - 1];
+    }
+    starts[0] = 0;
+}
+
+/**
+ * Sequential reader of DIMACS bytes: either the whole memory-mapped file, or chunks read from a stream
+ * (pipes and other files, which cannot be mapped). Compressed input is decompressed chunk by chunk.
+ */
+typedef struct DimacsScanner {
+    const char* pos;
+    const char* end;
+    FILE* fp;                     // Source of chunks, NULL if the file is mapped
+    char* buffer;                 // Chunk buffer, NULL if the plain file is mapped
+    void* mapped;
+    size_t mapped_len;
+    Decompressor* decompressor;   // NULL for plain input
+    const unsigned char* input;   // Compressed bytes, which are not decompressed yet
+    size_t input_len;
+    unsigned char* input_buffer;  // Chunk buffer for compressed bytes read from the stream
+    size_t line_num;
+    bool failed;                  // Input could not be read or decompressed
+} DimacsScanner;
+
+static int open_scanner(DimacsScanner* scanner, FILE* fp) {
+    assert(scanner != NULL);
+    assert(fp != NULL);
+
+    *scanner = (DimacsScanner) {0};
+    scanner->line_num = 1;
+
+    struct stat st;
+    off_t offset = ftello(fp);
+    if (fstat(fileno(fp), &st) == 0 && S_ISREG(st.st_mode) && offset >= 0 && st.st_size > offset) {
+        void* mapped = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+        if (mapped != MAP_FAILED) {
+            madvise(mapped, (size_t) st.st_size, MADV_SEQUENTIAL);
+            scanner->mapped = mapped;
+            scanner->mapped_len = (size_t) st.st_size;
+            scanner->input = (const unsigned char*) mapped + offset;
+            scanner->input_len = (size_t) (st.st_size - offset);
+        }
+    }
+    if (scanner->mapped == NULL) {
+        scanner->fp = fp;
+        scanner->input_buffer = (unsigned char*) malloc(SCANNER_CHUNK_SIZE);
+        if (scanner->input_buffer == NULL) {
+            CNF_PARSE_ERROR("Insufficient memory");
+            return -1;
+        }
+        scanner->input = scanner->input_buffer;
+        scanner->input_len = fread(scanner->input_buffer, 1, SCANNER_CHUNK_SIZE, fp);
+        if (ferror(fp)) {
+            CNF_PARSE_ERROR("Failed to read input");
             return -1;
         }
-        vars[real_vars_num++] = var;
     }
-    if (var != 0 || token != NULL) {
-        CLAUSE_PARSE_ERROR("Variables should be terminated with zero");
-        free(vars);
-        return -1;
+
+    Compression compression = detect_compression(scanner->input, scanner->input_len);
+    if (compression == COMPRESSION_NONE) {
+        // Plain text is scanned right from the mapping or the chunk buffer
+        scanner->pos = (const char*) scanner->input;
+        scanner->end = (const char*) scanner->input + scanner->input_len;
+        scanner->buffer = (char*) scanner->input_buffer;
+        scanner->input_buffer = NULL;
+        scanner->input_len = 0;
+        return 0;
     }
 
-    signed int* shrinked_vars = (signed int*) realloc(vars, real_vars_num * sizeof(signed int));
-    if (shrinked_vars == NULL) {
-        CLAUSE_PARSE_ERROR("Insufficient memory");
-        free(vars);
+    scanner->decompressor = create_decompressor(compression);
+    scanner->buffer = (char*) malloc(SCANNER_CHUNK_SIZE);
+    if (scanner->decompressor == NULL || scanner->buffer == NULL) {
+        CNF_PARSE_ERROR_F("Failed to start %s decompression", compression_name(compression));
         return -1;
     }
-    clause->len = real_vars_num;
-    clause->vars = shrinked_vars; // TODO: Validate, that all vars are unique
+    scanner->pos = scanner->buffer;
+    scanner->end = scanner->buffer;
     return 0;
 }
 
-CNF* read_dimacs_cnf(FILE* fp) {
-    assert(fp != NULL);
+static void close_scanner(DimacsScanner* scanner) {
+    assert(scanner != NULL);
 
-    char* line = NULL;
-    size_t len = 0;
-    ssize_t read = -1;
-    size_t vars_num = 0;
-    size_t clauses_num = 0;
-    Clause** clauses = NULL;
-    size_t current_clause_num = 0;
-    size_t line_num = 0;
-    CNF* cnf = NULL;
-    while ((read = getline(&line, &len, fp)) != -1) {
-        ++line_num;
-        if (read < 2) {
-            // Empty line
-            continue;
+    if (scanner->mapped != NULL) {
+        munmap(scanner->mapped, scanner->mapped_len);
+    }
+    free_decompressor(scanner->decompressor);
+    free(scanner->input_buffer);
+    free(scanner->buffer);
+}
+
+static int refill_plain_scanner(DimacsScanner* scanner) {
+    assert(scanner != NULL);
+
+    if (scanner->fp == NULL) {
+        return EOF;
+    }
+    size_t read = fread(scanner->buffer, 1, SCANNER_CHUNK_SIZE, scanner->fp);
+    if (read == 0 && ferror(scanner->fp)) {
+        CNF_PARSE_ERROR("Failed to read input");
+        scanner->failed = true;
+    }
+    scanner->pos = scanner->buffer;
+    scanner->end = scanner->buffer + read;
+    return read > 0 ? (unsigned char) *scanner->pos : EOF;
+}
+
+static int refill_scanner(DimacsScanner* scanner) {
+    assert(scanner != NULL);
+
+    if (scanner->failed) {
+        return EOF;
+    }
+    if (scanner->decompressor == NULL) {
+        return refill_plain_scanner(scanner);
+    }
+
+    for (;;) {
+        if (scanner->input_len == 0 && scanner->fp != NULL) {
+            scanner->input = scanner->input_buffer;
+            scanner->input_len = fread(scanner->input_buffer, 1, SCANNER_CHUNK_SIZE, scanner->fp);
+            if (ferror(scanner->fp)) {
+                CNF_PARSE_ERROR("Failed to read input");
+                scanner->failed = true;
+                return EOF;
+            }
         }
-        if (line[0] == 'c') {
-            // Comment
-            continue;
+
+        bool has_input = scanner->input_len > 0;
+        long written = decompress(scanner->decompressor, &scanner->input, &scanner->input_len, scanner->buffer, SCANNER_CHUNK_SIZE);
+        if (written < 0) {
+            scanner->failed = true;
+            return EOF;
         }
-        if (line[0] == 'p') {
-            // Number of variables and clauses
-            if (vars_num != 0 && clauses_num != 0) {
-                CNF_PARSE_ERROR_F("Number of vars and clauses is set twice (line #%zu)", line_num);
-                goto error;
+        if (written > 0) {
+            scanner->pos = scanner->buffer;
+            scanner->end = scanner->buffer + written;
+            return (unsigned char) *scanner->pos;
+        }
+        if (!has_input) {
+            if (!decompressor_is_finished(scanner->decompressor)) {
+                CNF_PARSE_ERROR("Unexpected end of compressed input");
+                scanner->failed = true;
             }
+            scanner->pos = scanner->buffer;
+            scanner->end = scanner->buffer;
+            return EOF;
+        }
+    }
+}
 
-            const char* delims = " \t";
-            char* token = NULL;
+static inline int scanner_peek(DimacsScanner* scanner) {
+    if (scanner->pos < scanner->end) {
+        return (unsigned char) *scanner->pos;
+    }
+    return refill_scanner(scanner);
+}
 
-            token = strtok(line + 1 * sizeof(char), delims);
-            if (token == NULL) {
-                CLAUSE_PARSE_ERROR_F("Bad syntax in vars and clauses declaration: expected 'cnf', but got nothing (line #%zu)", line_num);
-                goto error;
-            }
-            if (strlen(token) < 3UL || strncmp(token, "cnf", 3UL)) {
-                CLAUSE_PARSE_ERROR_F("Bad syntax in vars and clauses declaration: expected 'cnf', but got '%s' (line #%zu)", token, line_num);
-                goto error;
+/**
+ * Skips spaces, tabs and (if skip_lines is set) line breaks. Returns the next character or EOF.
+ */
+static inline int skip_blanks(DimacsScanner* scanner, bool skip_lines) {
+    for (;;) {
+        const char* pos = scanner->pos;
+        const char* end = scanner->end;
+        for (; pos < end; ++pos) {
+            char c = *pos;
+            if (c == '\n' && skip_lines) {
+                ++scanner->line_num;
+            } else if (c != ' ' && c != '\t' && c != '\r' && (c != '\n' || !skip_lines)) {
+                scanner->pos = pos;
+                return (unsigned char) c;
             }
+        }
+        scanner->pos = pos;
+        if (refill_scanner(scanner) == EOF) {
+            return EOF;
+        }
+    }
+}
 
-            token = strtok(NULL, delims);
-            if (token == NULL) {
-                CLAUSE_PARSE_ERROR_F("Bad syntax in vars and clauses declaration: expected vars num, but got nothing (line #%zu)", line_num);
-                goto error;
+static void skip_line(DimacsScanner* scanner) {
+    for (;;) {
+        const char* newline = (const char*) memchr(scanner->pos, '\n', (size_t) (scanner->end - scanner->pos));
+        if (newline != NULL) {
+            scanner->pos = newline;
+            return;
+        }
+        scanner->pos = scanner->end;
+        if (refill_scanner(scanner) == EOF) {
+            return;
+        }
+    }
+}
+
+/**
+ * Scans an optionally signed decimal integer, which absolute value is not greater than the limit.
+ */
+static int scan_int(DimacsScanner* scanner, long long limit, long long* value) {
+    assert(scanner != NULL);
+    assert(value != NULL);
+    assert(limit <= LLONG_MAX / 10);
+
+    if (scanner->end - scanner->pos > SCANNER_MAX_INT_LEN) {
+        // Fast path: the number is scanned in place, unless it runs up to the end of the chunk (e.g. leading zeros)
+        const char* pos = scanner->pos;
+        const char* end = scanner->end;
+        bool is_negative = *pos == '-';
+        pos += is_negative ? 1 : 0;
+        if ((unsigned char) (*pos - '0') >= 10) {
+            return -1;
+        }
+        long long result = 0;
+        do {
+            result = result * 10 + (*pos++ - '0');
+            if (result > limit) {
+                return -1;
             }
-            vars_num = atoi(token);
+        } while (pos < end && (unsigned char) (*pos - '0') < 10);
+        if (pos < end) {
+            if (*pos != ' ' && *pos != '\t' && *pos != '\r' && *pos != '\n') {
+                return -1;
+            }
+            scanner->pos = pos;
+            *value = is_negative ? -result : result;
+            return 0;
+        }
+    }
 
-            token = strtok(NULL, delims);
-            if (token == NULL) {
-                CLAUSE_PARSE_ERROR_F("Bad syntax in vars and clauses declaration: expected clauses num, but got nothing (line #%zu)", line_num);
-                goto error;
+    bool is_negative = false;
+    int c = scanner_peek(scanner);
+    if (c == '-') {
+        is_negative = true;
+        ++scanner->pos;
+        c = scanner_peek(scanner);
+    }
+    if (c < '0' || c > '9') {
+        return -1;
+    }
+
+    long long result = 0;
+    for (;;) {
+        // Digits are consumed in place until the end of the current chunk
+        const char* pos = scanner->pos;
+        const char* end = scanner->end;
+        while (pos < end && (unsigned char) (*pos - '0') < 10) {
+            result = result * 10 + (*pos - '0');
+            if (result > limit) {
+                scanner->pos = pos;
+                return -1;
             }
-            clauses_num = atoi(token);
+            ++pos;
+        }
+        scanner->pos = pos;
+        if (pos < end || refill_scanner(scanner) == EOF) {
+            break;
+        }
+    }
+
+    c = scanner_peek(scanner);
+    if (c != EOF && c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+        return -1;
+    }
+    *value = is_negative ? -result : result;
+    return 0;
+}
 
-            token = strtok(NULL, delims);
-            if (token != NULL) {
-                CLAUSE_PARSE_ERROR_F("Bad syntax in vars and clauses declaration: expected EOL, but got '%s' (line #%zu)", token, line_num);
+static int scan_header(DimacsScanner* scanner, size_t* vars_num, size_t* clauses_num) {
+    assert(scanner != NULL);
+
+    ++scanner->pos; // 'p'
+    skip_blanks(scanner, false);
+    const char* format = "cnf";
+    for (size_t i = 0; format[i] != '\0'; ++i) {
+        if (scanner_peek(scanner) != format[i]) {
+            CNF_PARSE_ERROR_F("Bad syntax in vars and clauses declaration: expected 'cnf' (line #%zu)", scanner->line_num);
+            return -1;
+        }
+        ++scanner->pos;
+    }
+
+    long long value = 0;
+    skip_blanks(scanner, false);
+    if (scan_int(scanner, INT_MAX, &value) != 0 || value < 0) {
+        CNF_PARSE_ERROR_F("Bad syntax in vars and clauses declaration: expected vars num (line #%zu)", scanner->line_num);
+        return -1;
+    }
+    *vars_num = (size_t) value;
+    skip_blanks(scanner, false);
+    if (scan_int(scanner, LLONG_MAX / 10, &value) != 0 || value < 0) {
+        CNF_PARSE_ERROR_F("Bad syntax in vars and clauses declaration: expected clauses num (line #%zu)", scanner->line_num);
+        return -1;
+    }
+    *clauses_num = (size_t) value;
+
+    int c = skip_blanks(scanner, false);
+    if (c != EOF && c != '\n') {
+        CNF_PARSE_ERROR_F("Bad syntax in vars and clauses declaration: expected EOL, but got '%c' (line #%zu)", c, scanner->line_num);
+        return -1;
+    }
+    return 0;
+}
+
+CNF* read_dimacs_cnf(FILE* fp) {
+    assert(fp != NULL);
+
+    DimacsScanner scanner;
+    if (open_scanner(&scanner, fp) != 0) {
+        close_scanner(&scanner);
+        return NULL;
+    }
+
+    size_t clauses_num = 0;
+    size_t clause_len = 0; // Vars of the current clause, that are already stored after the last clause
+    CNF* cnf = NULL;
+    int c = EOF;
+    while ((c = skip_blanks(&scanner, true)) != EOF) {
+        if (c == 'c') {
+            // Comment
+            skip_line(&scanner);
+        } else if (c == 'p') {
+            // Number of variables and clauses
+            if (cnf != NULL) {
+                CNF_PARSE_ERROR_F("Number of vars and clauses is set twice (line #%zu)", scanner.line_num);
                 goto error;
             }
-
-            clauses = (Clause**) calloc(clauses_num, sizeof(Clause));
-            if (clauses == NULL) {
-                CNF_PARSE_ERROR_F("Insufficient memory (line #%zu)", line_num);
+            size_t vars_num = 0;
+            if (scan_header(&scanner, &vars_num, &clauses_num) != 0) {
                 goto error;
             }
-            for (size_t i = 0; i < clauses_num; ++i) {
-                clauses[i] = (Clause*) calloc(1, sizeof(Clause));
-                if (clauses[i] == NULL) {
-                    CNF_PARSE_ERROR_F("CNF Parse Error: Insufficient memory (line #%zu)", line_num);
-                    goto error;
-                }
+            cnf = create_cnf(vars_num, clauses_num, 3 * clauses_num);
+            if (cnf == NULL) {
+                CNF_PARSE_ERROR_F("Insufficient memory (line #%zu)", scanner.line_num);
+                goto error;
             }
+        } else if (c == '%') {
+            // End of formula in SATLIB benchmarks
+            break;
         } else {
-            // Clause
-            if (vars_num == 0 || clauses_num == 0) {
-                CNF_PARSE_ERROR_F("Clause is met, but number of clauses was not defined previously (line #%zu)", line_num);
+            // Clause var, clauses may span several lines
+            if (cnf == NULL) {
+                CNF_PARSE_ERROR_F("Clause is met, but number of clauses was not defined previously (line #%zu)", scanner.line_num);
                 goto error;
             }
-            if (current_clause_num == clauses_num) {
-                CNF_PARSE_ERROR_F("Too many clauses (line #%zu)", line_num);
+            long long var = 0;
+            if (scan_int(&scanner, (long long) cnf->vars_num, &var) != 0) {
+                CLAUSE_PARSE_ERROR_F("Expected variables in [-%zu; %zu] terminated with zero (line #%zu)", cnf->vars_num, cnf->vars_num, scanner.line_num);
                 goto error;
             }
+            if (var != 0) {
+                if (cnf->vars_len + clause_len == cnf->vars_capacity && reserve_cnf_vars(cnf, cnf->vars_capacity + 1) != 0) {
+                    CNF_PARSE_ERROR_F("Insufficient memory (line #%zu)", scanner.line_num);
+                    goto error;
+                }
+                cnf->vars[cnf->vars_len + clause_len++] = (signed int) var;
+                continue;
+            }
 
-            Clause* current_clause = clauses[current_clause_num++];
-            if (read_dimacs_clause(line, vars_num, current_clause) != 0) {
-                CNF_PARSE_ERROR_F("Bad clause syntax (line #%zu)", line_num);
+            if (cnf->clauses_num == clauses_num) {
+                CNF_PARSE_ERROR_F("Too many clauses (line #%zu)", scanner.line_num);
                 goto error;
             }
+            Clause* clause = &cnf->clauses[cnf->clauses_num++];
+            clause->offset = cnf->vars_len;
+            clause->len = clause_len;
+            cnf->vars_len += clause_len;
+            clause_len = 0;
         }
     }
-    free(line);
-    line = NULL;
 
+    if (scanner.failed) {
+        goto error;
+    }
+    if (clause_len != 0) {
+        CLAUSE_PARSE_ERROR("Variables should be terminated with zero");
+        goto error;
+    }
+    size_t current_clause_num = cnf != NULL ? cnf->clauses_num : 0;
     if (current_clause_num != clauses_num) {
         CNF_PARSE_ERROR_F("Expected %zu clauses, but got %zu", clauses_num, current_clause_num);
         goto error;
     }
-
-    cnf = (CNF*) calloc(1, sizeof(CNF));
     if (cnf == NULL) {
-        CNF_PARSE_ERROR("Insufficient memory");
-        goto error;
+        // Neither clauses, nor their number were declared
+        cnf = create_cnf(0, 0, 0);
+        if (cnf == NULL) {
+            CNF_PARSE_ERROR("Insufficient memory");
+            goto error;
+        }
     }
-    cnf->vars_num = vars_num;
-    cnf->clauses_num = clauses_num;
-    cnf->clauses = clauses;
+
+    close_scanner(&scanner);
     return cnf;
 
 error:
-    free(line);
-    if (clauses != NULL) {
-        for (size_t i = 0; i < clauses_num; ++i) {
-            if (clauses[i] != NULL) {
-                free(clauses[i]->vars);
-                free(clauses[i]);
-            }
-        }
-        free(clauses);
-    }
-    free(cnf);
+    close_scanner(&scanner);
+    free_cnf(cnf);
     return NULL;
 }
 
 void free_cnf(CNF* cnf) {
     if (cnf != NULL) {
-        for (size_t i = 0; i < cnf->clauses_num; ++i) {
-            free(cnf->clauses[i]->vars);
-            free(cnf->clauses[i]);
-        }
         free(cnf->clauses);
+        free(cnf->vars);
         free(cnf);
     }
 }
-
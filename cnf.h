@@ -1,21 +1,59 @@
 #pragma once
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 typedef struct Clause {
+    size_t offset; // Index of the first var of the clause in CNF vars arena
     size_t len;
-    signed int* vars;
 } Clause;
 
 typedef struct CNF {
     size_t vars_num;
     size_t clauses_num;
-    Clause** clauses;
+    Clause* clauses;
+    signed int* vars;              // Vars of all clauses, stored one clause after another
+    size_t vars_len;               // Total number of vars in all clauses
+    size_t vars_capacity;
 } CNF;
 
-int read_dimacs_clause(char* line, size_t max_vars_num, Clause* clause);
+static inline size_t cnf_lit_index(signed int var) {
+    // Positive and negative literals of the same variable are neighbours
+    return 2 * ((var > 0 ? var : -var) - 1) + (var < 0 ? 1 : 0);
+}
 
+static inline signed int* cnf_clause_vars(const CNF* cnf, const Clause* clause) {
+    return cnf->vars + clause->offset;
+}
+
+/**
+ * Returns vars of the clause with the given number of some clause storage and stores their count in len.
+ */
+typedef const signed int* (*ClauseVarsGetter)(const void* clauses, size_t clause_num, size_t* len);
+
+/**
+ * Creates CNF without clauses, that can hold clauses_capacity clauses (arena grows on demand).
+ */
+CNF* create_cnf(size_t vars_num, size_t clauses_capacity, size_t vars_capacity);
+
+int cnf_add_clause(CNF* cnf, const signed int* vars, size_t len);
+
+/**
+ * Groups clause numbers by literals they contain (CSR): clauses with the literal of index i (see cnf_lit_index)
+ * are occurances[starts[i]] to occurances[starts[i + 1] - 1]. Starts should have lits_num + 1 items,
+ * and occurances should have an item per var of all clauses.
+ */
+void build_occurances(const void* clauses, size_t clauses_num, ClauseVarsGetter clause_vars, size_t lits_num,
+                      size_t* starts, size_t* occurances);
+
+/**
+ * Checks, that every clause has a var with the value from model (value of var i is model[i - 1]).
+ */
+bool cnf_is_satisfied_by(const CNF* cnf, const bool* model);
+
+/**
+ * Parses CNF in DIMACS format. Regular files are memory-mapped, other ones are read in chunks.
+ */
 CNF* read_dimacs_cnf(FILE* fp);
 
 void free_cnf(CNF* cnf);
-
@@ -0,0 +1,421 @@
+#define  _GNU_SOURCE
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "cube.h"
+#include "debug.h"
+
+#define CUBE_ERROR(msg) do { \
+    fprintf(stderr, "Cube Error: " msg "\n"); \
+} while (0)
+
+#define CUBE_LOOKAHEAD_CANDIDATES 32 // Vars probed by look-ahead at each node of the splitting tree
+#define CUBE_DEPTH_EXTRA          4  // Auto depth gives 2^4 cubes per thread, so that stealing can balance them
+#define CUBE_DEPTH_MAX            24
+
+#define NO_WINNER ((size_t) -1)
+
+/**
+ * Cubes stored one after another, cube i is lits[starts[i]..starts[i + 1]).
+ */
+typedef struct CubeSet {
+    signed int* lits;
+    size_t lits_len;
+    size_t lits_capacity;
+    size_t* starts;
+    size_t cubes_num;
+    size_t cubes_capacity;
+} CubeSet;
+
+/**
+ * Cubes of a worker. The owner takes them from the tail, other workers steal from the head,
+ * so a thief gets the cube, which is the farthest from what the owner is solving now.
+ */
+typedef struct CubeDeque {
+    pthread_mutex_t lock;
+    size_t* cubes;
+    size_t head;
+    size_t tail;
+} CubeDeque;
+
+typedef struct CubePool {
+    const CNF* cnf;
+    const DpllOptions* options; // Budgets of the whole run, which are shared by all cubes
+    const CubeSet* cubes;
+    CubeDeque* deques;
+    size_t deques_num;
+    struct timespec start;
+    atomic_size_t conflicts;   // Spent on the solved cubes
+    atomic_size_t decisions;
+    atomic_bool cancelled;     // Set, once the answer is known or a worker failed
+    atomic_size_t winner;      // Index of the worker, that found a SAT cube, or NO_WINNER
+    atomic_bool is_unsat;      // Some worker refuted the CNF regardless of its cube
+    atomic_bool is_unknown;    // Some cube was left unsolved, because the run was cancelled or exhausted its budget
+    atomic_bool has_error;
+    bool* model;
+} CubePool;
+
+typedef struct CubeWorker {
+    pthread_t thread;
+    size_t index;
+    DpllOptions options;
+    DpllStats stats;
+    CubePool* pool;
+} CubeWorker;
+
+/**
+ * Counters and times are summed over solvers, while max depth is the max one. Solvers run at the same time,
+ * so their peak memory is summed too.
+ */
+static void add_stats(DpllStats* sum, const DpllStats* stats) {
+    sum->decisions += stats->decisions;
+    sum->propagations += stats->propagations;
+    sum->conflicts += stats->conflicts;
+    sum->backtracks += stats->backtracks;
+    sum->max_depth = stats->max_depth > sum->max_depth ? stats->max_depth : sum->max_depth;
+    sum->learned_clauses += stats->learned_clauses;
+    sum->deleted_clauses += stats->deleted_clauses;
+    sum->reductions += stats->reductions;
+    sum->restarts += stats->restarts;
+    sum->probed_units += stats->probed_units;
+    sum->flips += stats->flips;
+    sum->peak_memory += stats->peak_memory;
+    sum->search_time += stats->search_time;
+}
+
+static int cube_set_add(CubeSet* set, const signed int* lits, size_t len) {
+    assert(set != NULL);
+
+    if (set->lits_len + len > set->lits_capacity) {
+        size_t capacity = set->lits_capacity > 0 ? set->lits_capacity : 64;
+        while (capacity < set->lits_len + len) {
+            capacity *= 2;
+        }
+        signed int* new_lits = (signed int*) realloc(set->lits, capacity * sizeof(signed int));
+        if (new_lits == NULL) {
+            return -1;
+        }
+        set->lits = new_lits;
+        set->lits_capacity = capacity;
+    }
+    if (set->cubes_num + 2 > set->cubes_capacity) {
+        size_t capacity = set->cubes_capacity > 0 ? 2 * set->cubes_capacity : 16;
+        size_t* new_starts = (size_t*) realloc(set->starts, capacity * sizeof(size_t));
+        if (new_starts == NULL) {
+            return -1;
+        }
+        set->starts = new_starts;
+        set->cubes_capacity = capacity;
+    }
+    for (size_t i = 0; i < len; ++i) {
+        set->lits[set->lits_len + i] = lits[i];
+    }
+    set->starts[set->cubes_num] = set->lits_len;
+    set->lits_len += len;
+    set->starts[++set->cubes_num] = set->lits_len;
+    return 0;
+}
+
+/**
+ * Depth-first splitting: cube is extended by the look-ahead branch var with both values until it
+ * is depth_left vars longer. Cubes refuted by look-ahead are dropped. Returns -1 on error.
+ */
+static int split_cube(DpllSolver* solver, CubeSet* set, signed int* cube, size_t cube_len, size_t depth_left) {
+    signed int branch_var = 0;
+    DpllResult result = dpll_lookahead(solver, cube, cube_len, CUBE_LOOKAHEAD_CANDIDATES, &branch_var);
+    if (result == ERROR) {
+        return -1;
+    }
+    if (result == UNSAT) {
+        return 0;
+    }
+    if (result == SAT || depth_left == 0 || branch_var == 0) {
+        return cube_set_add(set, cube, cube_len);
+    }
+    cube[cube_len] = branch_var;
+    if (split_cube(solver, set, cube, cube_len + 1, depth_left - 1) != 0) {
+        return -1;
+    }
+    cube[cube_len] = -branch_var;
+    return split_cube(solver, set, cube, cube_len + 1, depth_left - 1);
+}
+
+static bool pop_own_cube(CubeDeque* deque, size_t* cube) {
+    bool found = false;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->head < deque->tail) {
+        *cube = deque->cubes[--deque->tail];
+        found = true;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+static bool steal_cube(CubeDeque* deque, size_t* cube) {
+    bool found = false;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->head < deque->tail) {
+        *cube = deque->cubes[deque->head++];
+        found = true;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+static bool take_cube(CubePool* pool, size_t index, size_t* cube) {
+    if (pop_own_cube(&pool->deques[index], cube)) {
+        return true;
+    }
+    for (size_t i = 1; i < pool->deques_num; ++i) {
+        if (steal_cube(&pool->deques[(index + i) % pool->deques_num], cube)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static double elapsed_seconds(const struct timespec* start) {
+    assert(start != NULL);
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) (now.tv_sec - start->tv_sec) + (double) (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * Each cube gets what is left of the budgets of the run. Returns false, if some of them is already exhausted.
+ */
+static bool set_cube_budgets(CubeWorker* worker) {
+    assert(worker != NULL);
+
+    CubePool* pool = worker->pool;
+    const DpllOptions* options = pool->options;
+    DpllOptions* cube_options = &worker->options;
+    if (options->time_limit > 0.0) {
+        double left = options->time_limit - elapsed_seconds(&pool->start);
+        if (left <= 0.0) {
+            return false;
+        }
+        cube_options->time_limit = left;
+    }
+    if (options->conflicts_limit > 0) {
+        size_t spent = atomic_load(&pool->conflicts);
+        if (spent >= options->conflicts_limit) {
+            return false;
+        }
+        cube_options->conflicts_limit = options->conflicts_limit - spent;
+    }
+    if (options->decisions_limit > 0) {
+        size_t spent = atomic_load(&pool->decisions);
+        if (spent >= options->decisions_limit) {
+            return false;
+        }
+        cube_options->decisions_limit = options->decisions_limit - spent;
+    }
+    return true;
+}
+
+static void* run_worker(void* arg) {
+    CubeWorker* worker = (CubeWorker*) arg;
+    CubePool* pool = worker->pool;
+
+    // Each worker keeps its solver for all its cubes, so clauses learned on one cube help with the next ones
+    DpllSolver* solver = dpll_create_solver(pool->cnf, &worker->options);
+    if (solver == NULL) {
+        atomic_store(&pool->has_error, true);
+        atomic_store(&pool->cancelled, true);
+        return NULL;
+    }
+    dpll_fix_unused_vars(solver);
+
+    size_t cube = 0;
+    while (!atomic_load_explicit(&pool->cancelled, memory_order_relaxed) && take_cube(pool, worker->index, &cube)) {
+        if (!set_cube_budgets(worker)) {
+            atomic_store(&pool->is_unknown, true);
+            atomic_store(&pool->cancelled, true);
+            break;
+        }
+        const CubeSet* set = pool->cubes;
+        size_t start = set->starts[cube];
+        const DpllStats* stats = dpll_solver_stats(solver);
+        size_t conflicts = stats->conflicts;
+        size_t decisions = stats->decisions;
+        DpllResult result = dpll_solve(solver, set->lits + start, set->starts[cube + 1] - start);
+        atomic_fetch_add(&pool->conflicts, stats->conflicts - conflicts);
+        atomic_fetch_add(&pool->decisions, stats->decisions - decisions);
+        if (result == SAT) {
+            size_t no_winner = NO_WINNER;
+            if (atomic_compare_exchange_strong(&pool->winner, &no_winner, worker->index) && pool->model != NULL) {
+                dpll_solver_model(solver, pool->model);
+            }
+            atomic_store(&pool->cancelled, true);
+        } else if (result == UNSAT && dpll_solver_is_unsat(solver)) {
+            atomic_store(&pool->is_unsat, true);
+            atomic_store(&pool->cancelled, true);
+        } else if (result == ERROR) {
+            atomic_store(&pool->has_error, true);
+            atomic_store(&pool->cancelled, true);
+        } else if (result == UNKNOWN) {
+            atomic_store(&pool->is_unknown, true);
+            atomic_store(&pool->cancelled, true);
+        }
+    }
+
+    worker->stats = *dpll_solver_stats(solver);
+    dpll_free_solver(solver);
+    return NULL;
+}
+
+static size_t auto_depth(size_t threads_num) {
+    size_t depth = CUBE_DEPTH_EXTRA;
+    for (size_t n = threads_num; n > 1; n /= 2) {
+        ++depth;
+    }
+    return depth;
+}
+
+DpllResult cube_check_sat(const CNF* cnf, const DpllOptions* options, size_t threads_num, size_t depth, DpllStats* stats, bool* model) {
+    assert(cnf != NULL);
+    assert(options != NULL);
+    assert(threads_num > 0);
+
+    DpllResult result = ERROR;
+    CubeSet set = {0};
+    CubeWorker* workers = NULL;
+    size_t started_num = 0;
+    size_t deques_initialized = 0;
+    signed int* cube = NULL;
+    CubePool pool = {0};
+    pool.cnf = cnf;
+    pool.options = options;
+    pool.cubes = &set;
+    pool.deques_num = threads_num;
+    pool.model = model;
+    atomic_init(&pool.cancelled, false);
+    atomic_init(&pool.winner, NO_WINNER);
+    atomic_init(&pool.is_unsat, false);
+    atomic_init(&pool.is_unknown, false);
+    atomic_init(&pool.has_error, false);
+    atomic_init(&pool.conflicts, 0);
+    atomic_init(&pool.decisions, 0);
+    clock_gettime(CLOCK_MONOTONIC, &pool.start);
+    if (stats != NULL) {
+        memset(stats, 0, sizeof(DpllStats));
+    }
+
+    depth = depth > 0 ? depth : auto_depth(threads_num);
+    depth = depth < CUBE_DEPTH_MAX ? depth : CUBE_DEPTH_MAX;
+    DpllSolver* splitter = dpll_create_solver(cnf, options);
+    cube = (signed int*) malloc((depth + 1) * sizeof(signed int));
+    if (splitter == NULL || cube == NULL) {
+        CUBE_ERROR("Insufficient memory");
+        goto exit;
+    }
+    dpll_fix_unused_vars(splitter);
+    if (split_cube(splitter, &set, cube, 0, depth) != 0) {
+        CUBE_ERROR("Failed to split CNF into cubes");
+        goto exit;
+    }
+    if (stats != NULL) {
+        add_stats(stats, dpll_solver_stats(splitter));
+    }
+    dpll_free_solver(splitter);
+    splitter = NULL;
+    DEBUG_PRINTF("Split CNF into %zu cubes of depth up to %zu", set.cubes_num, depth);
+    if (set.cubes_num == 0) {
+        // Look-ahead refuted every branch by itself
+        result = UNSAT;
+        goto exit;
+    }
+
+    pool.deques = (CubeDeque*) calloc(threads_num, sizeof(CubeDeque));
+    workers = (CubeWorker*) calloc(threads_num, sizeof(CubeWorker));
+    if (pool.deques == NULL || workers == NULL) {
+        CUBE_ERROR("Insufficient memory");
+        goto exit;
+    }
+    for (; deques_initialized < threads_num; ++deques_initialized) {
+        CubeDeque* deque = &pool.deques[deques_initialized];
+        deque->cubes = (size_t*) malloc((set.cubes_num / threads_num + 1) * sizeof(size_t));
+        if (deque->cubes == NULL || pthread_mutex_init(&deque->lock, NULL) != 0) {
+            free(deque->cubes);
+            CUBE_ERROR("Insufficient memory");
+            goto exit;
+        }
+    }
+    // Neighbouring cubes share the longest prefix, so each worker starts with a different part of the tree
+    for (size_t i = 0; i < set.cubes_num; ++i) {
+        CubeDeque* deque = &pool.deques[i * threads_num / set.cubes_num];
+        deque->cubes[deque->tail++] = i;
+    }
+    for (size_t i = 0; i < threads_num; ++i) {
+        // Owner takes cubes from the tail, so its first cube is the first one of its part
+        CubeDeque* deque = &pool.deques[i];
+        for (size_t j = 0; j < (deque->tail - deque->head) / 2; ++j) {
+            size_t tmp = deque->cubes[j];
+            deque->cubes[j] = deque->cubes[deque->tail - 1 - j];
+            deque->cubes[deque->tail - 1 - j] = tmp;
+        }
+    }
+
+    for (size_t i = 0; i < threads_num; ++i) {
+        workers[i].index = i;
+        workers[i].options = *options;
+        workers[i].options.cancelled = &pool.cancelled;
+        workers[i].options.terminate = dpll_options_terminated;
+        workers[i].options.terminate_data = (void*) options;
+        // Lemmas of concurrent searches do not make a proof of the whole CNF
+        workers[i].options.proof = NULL;
+        if (i > 0) {
+            // Progress of the first worker stands for the whole pool
+            workers[i].options.progress = NULL;
+        }
+        workers[i].pool = &pool;
+    }
+    for (; started_num < threads_num; ++started_num) {
+        if (pthread_create(&workers[started_num].thread, NULL, run_worker, &workers[started_num]) != 0) {
+            CUBE_ERROR("Failed to start worker thread");
+            atomic_store(&pool.has_error, true);
+            atomic_store(&pool.cancelled, true);
+            break;
+        }
+    }
+    for (size_t i = 0; i < started_num; ++i) {
+        pthread_join(workers[i].thread, NULL);
+        if (stats != NULL) {
+            add_stats(stats, &workers[i].stats);
+        }
+    }
+
+    if (atomic_load(&pool.winner) != NO_WINNER) {
+        result = SAT;
+    } else if (atomic_load(&pool.is_unsat)) {
+        result = UNSAT;
+    } else if (atomic_load(&pool.has_error)) {
+        result = ERROR;
+    } else if (atomic_load(&pool.is_unknown)) {
+        result = UNKNOWN;
+    } else {
+        // Workers stop only after their deques are empty, so every cube was refuted
+        result = UNSAT;
+    }
+
+exit:
+    if (pool.deques != NULL) {
+        for (size_t i = 0; i < deques_initialized; ++i) {
+            pthread_mutex_destroy(&pool.deques[i].lock);
+            free(pool.deques[i].cubes);
+        }
+    }
+    free(pool.deques);
+    free(workers);
+    free(cube);
+    free(set.lits);
+    free(set.starts);
+    dpll_free_solver(splitter);
+    return result;
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include "cnf.h"
+#include "dpll.h"
+
+/**
+ * Cube-and-conquer: splits the CNF by look-ahead into cubes (partial assignments of up to depth vars,
+ * 0 picks the depth by threads_num), which are solved as assumptions by threads_num workers stealing
+ * cubes from each other. CNF is SAT, once any cube is, and UNSAT, once every cube is refuted.
+ * Stats are summed over all workers, model is stored as in dpll_check_sat.
+ */
+DpllResult cube_check_sat(const CNF* cnf, const DpllOptions* options, size_t threads_num, size_t depth, DpllStats* stats, bool* model);
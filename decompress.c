@@ -0,0 +1,224 @@
+#include <assert.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_LZMA
+#include <lzma.h>
+#endif
+#include "decompress.h"
+
+#define DECOMPRESS_ERROR(msg) do { \
+    fprintf(stderr, "Decompress Error: " msg "\n"); \
+} while (0)
+
+#define DECOMPRESS_ERROR_F(fmt, ...) do { \
+    fprintf(stderr, "Decompress Error: " fmt "\n", ##__VA_ARGS__); \
+} while (0)
+
+struct Decompressor {
+    Compression compression;
+    bool is_finished; // The last compressed stream has ended, another one may follow (concatenated files)
+#ifdef HAVE_ZLIB
+    z_stream zlib;
+#endif
+#ifdef HAVE_LZMA
+    lzma_stream lzma;
+#endif
+};
+
+Compression detect_compression(const unsigned char* bytes, size_t len) {
+    assert(bytes != NULL || len == 0);
+
+    static const unsigned char gzip_magic[] = {0x1F, 0x8B};
+    static const unsigned char xz_magic[] = {0xFD, '7', 'z', 'X', 'Z', 0x00};
+    if (len >= sizeof(gzip_magic) && memcmp(bytes, gzip_magic, sizeof(gzip_magic)) == 0) {
+        return COMPRESSION_GZIP;
+    }
+    if (len >= sizeof(xz_magic) && memcmp(bytes, xz_magic, sizeof(xz_magic)) == 0) {
+        return COMPRESSION_XZ;
+    }
+    return COMPRESSION_NONE;
+}
+
+const char* compression_name(Compression compression) {
+    switch (compression) {
+        case COMPRESSION_NONE:
+            return "plain";
+        case COMPRESSION_GZIP:
+            return "gzip";
+        case COMPRESSION_XZ:
+            return "xz";
+        default:
+            return "unknown";
+    }
+}
+
+static int init_stream(Decompressor* decompressor) {
+    assert(decompressor != NULL);
+
+    switch (decompressor->compression) {
+#ifdef HAVE_ZLIB
+        case COMPRESSION_GZIP:
+            // 16 selects gzip header instead of zlib one
+            return inflateInit2(&decompressor->zlib, 16 + MAX_WBITS) == Z_OK ? 0 : -1;
+#endif
+#ifdef HAVE_LZMA
+        case COMPRESSION_XZ: {
+            lzma_stream empty_stream = LZMA_STREAM_INIT;
+            decompressor->lzma = empty_stream;
+            // Concatenated streams and padding between them are decoded as a single stream
+            return lzma_stream_decoder(&decompressor->lzma, UINT64_MAX, LZMA_CONCATENATED) == LZMA_OK ? 0 : -1;
+        }
+#endif
+        default:
+            DECOMPRESS_ERROR_F("%s input is not supported by this build", compression_name(decompressor->compression));
+            return -1;
+    }
+}
+
+static void end_stream(Decompressor* decompressor) {
+    assert(decompressor != NULL);
+
+    switch (decompressor->compression) {
+#ifdef HAVE_ZLIB
+        case COMPRESSION_GZIP:
+            inflateEnd(&decompressor->zlib);
+            break;
+#endif
+#ifdef HAVE_LZMA
+        case COMPRESSION_XZ:
+            lzma_end(&decompressor->lzma);
+            break;
+#endif
+        default:
+            break;
+    }
+}
+
+Decompressor* create_decompressor(Compression compression) {
+    assert(compression != COMPRESSION_NONE);
+
+    Decompressor* decompressor = (Decompressor*) calloc(1, sizeof(Decompressor));
+    if (decompressor == NULL) {
+        DECOMPRESS_ERROR("Insufficient memory");
+        return NULL;
+    }
+    decompressor->compression = compression;
+    if (init_stream(decompressor) != 0) {
+        free(decompressor);
+        return NULL;
+    }
+    return decompressor;
+}
+
+void free_decompressor(Decompressor* decompressor) {
+    if (decompressor != NULL) {
+        end_stream(decompressor);
+        free(decompressor);
+    }
+}
+
+#ifdef HAVE_ZLIB
+static long decompress_gzip(Decompressor* decompressor, const unsigned char** input, size_t* input_len, char* output, size_t output_capacity) {
+    z_stream* stream = &decompressor->zlib;
+    stream->next_in = (Bytef*) *input;
+    stream->avail_in = (uInt) (*input_len < UINT_MAX ? *input_len : UINT_MAX);
+    stream->next_out = (Bytef*) output;
+    stream->avail_out = (uInt) (output_capacity < UINT_MAX ? output_capacity : UINT_MAX);
+
+    long result = 0;
+    // Decoder is called even without input, since it may hold output, which did not fit last time
+    while (stream->avail_out > 0) {
+        if (decompressor->is_finished) {
+            if (stream->avail_in == 0) {
+                break;
+            }
+            inflateReset(stream);
+            decompressor->is_finished = false;
+        }
+        uInt avail_in = stream->avail_in;
+        uInt avail_out = stream->avail_out;
+        int status = inflate(stream, Z_NO_FLUSH);
+        if (status == Z_STREAM_END) {
+            decompressor->is_finished = true;
+        } else if (status != Z_OK && status != Z_BUF_ERROR) {
+            DECOMPRESS_ERROR_F("Corrupted gzip input: %s", stream->msg != NULL ? stream->msg : "unknown error");
+            result = -1;
+            break;
+        } else if (status == Z_BUF_ERROR || (avail_in == stream->avail_in && avail_out == stream->avail_out)) {
+            // No progress is possible without more input
+            break;
+        }
+    }
+
+    size_t consumed = (size_t) (stream->next_in - *input);
+    *input += consumed;
+    *input_len -= consumed;
+    return result < 0 ? result : (long) ((char*) stream->next_out - output);
+}
+#endif
+
+#ifdef HAVE_LZMA
+static long decompress_xz(Decompressor* decompressor, const unsigned char** input, size_t* input_len, char* output, size_t output_capacity) {
+    lzma_stream* stream = &decompressor->lzma;
+    long result = 0;
+    stream->next_in = *input;
+    stream->avail_in = *input_len;
+    stream->next_out = (uint8_t*) output;
+    stream->avail_out = output_capacity;
+
+    // Empty input means the end of the file: only then the decoder knows, that no more concatenated streams follow
+    lzma_action action = *input_len == 0 ? LZMA_FINISH : LZMA_RUN;
+    // Decoder is called even without input, since it may hold output, which did not fit last time
+    while (stream->avail_out > 0 && !decompressor->is_finished) {
+        size_t avail_in = stream->avail_in;
+        size_t avail_out = stream->avail_out;
+        lzma_ret status = lzma_code(stream, action);
+        if (status == LZMA_STREAM_END) {
+            decompressor->is_finished = true;
+        } else if (status != LZMA_OK && status != LZMA_BUF_ERROR) {
+            DECOMPRESS_ERROR_F("Corrupted xz input (error %d)", (int) status);
+            result = -1;
+            break;
+        } else if (status == LZMA_BUF_ERROR || (avail_in == stream->avail_in && avail_out == stream->avail_out)) {
+            // No progress is possible without more input
+            break;
+        }
+    }
+
+    size_t consumed = (size_t) (stream->next_in - *input);
+    *input += consumed;
+    *input_len -= consumed;
+    return result < 0 ? result : (long) ((char*) stream->next_out - output);
+}
+#endif
+
+long decompress(Decompressor* decompressor, const unsigned char** input, size_t* input_len, char* output, size_t output_capacity) {
+    assert(decompressor != NULL);
+    assert(input != NULL);
+    assert(input_len != NULL);
+    assert(output != NULL);
+
+    switch (decompressor->compression) {
+#ifdef HAVE_ZLIB
+        case COMPRESSION_GZIP:
+            return decompress_gzip(decompressor, input, input_len, output, output_capacity);
+#endif
+#ifdef HAVE_LZMA
+        case COMPRESSION_XZ:
+            return decompress_xz(decompressor, input, input_len, output, output_capacity);
+#endif
+        default:
+            return -1;
+    }
+}
+
+bool decompressor_is_finished(const Decompressor* decompressor) {
+    assert(decompressor != NULL);
+
+    return decompressor->is_finished;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef enum {
+    COMPRESSION_NONE,
+    COMPRESSION_GZIP,
+    COMPRESSION_XZ,
+} Compression;
+
+typedef struct Decompressor Decompressor;
+
+/**
+ * Detects compression format by magic bytes at the start of the input.
+ */
+Compression detect_compression(const unsigned char* bytes, size_t len);
+
+const char* compression_name(Compression compression);
+
+/**
+ * Returns NULL, if there is not enough memory or the format is not supported by this build.
+ */
+Decompressor* create_decompressor(Compression compression);
+
+void free_decompressor(Decompressor* decompressor);
+
+/**
+ * Decompresses bytes from the input (advancing it past consumed bytes) into the output buffer.
+ * Returns number of bytes written to the output or -1 on corrupted data. Zero is returned only
+ * if the input is exhausted or the compressed stream is finished. Empty input marks the end of the file.
+ */
+long decompress(Decompressor* decompressor, const unsigned char** input, size_t* input_len, char* output, size_t output_capacity);
+
+/**
+ * Checks, that the whole compressed stream was decompressed, i.e. the input was not truncated.
+ */
+bool decompressor_is_finished(const Decompressor* decompressor);
@@ -1,9 +1,17 @@
+#define  _GNU_SOURCE
 #include <assert.h>
+#include <math.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include "clausedb.h"
 #include "cnf.h"
 #include "debug.h"
 #include "dpll.h"
+#include "heap.h"
+#include "localsearch.h"
+#include "trail.h"
 #include "trivector.h"
 
 #define DPLL_ERROR(msg) do { \
@@ -14,192 +22,543 @@
     fprintf(stderr, "DPLL Error: " fmt "\n", ##__VA_ARGS__); \
 } while (0)
 
-typedef struct DpllStateStack {
-    TriVector* vars_states;
-    struct DpllStateStack* previous;
-} DpllStateStack;
+#define VSIDS_DECAY          0.95
+#define VSIDS_RESCALE_LIMIT  1e100
+
+#define CLAUSE_ACTIVITY_DECAY 0.999
+#define CLAUSE_RESCALE_LIMIT  1e20
+
+#define REDUCE_DB_FIRST       2000 // Number of conflicts before the first learned clauses reduction
+#define REDUCE_DB_INC         300  // Increment of the interval between reductions
+#define REDUCE_DB_GLUE_LBD    2    // Learned clauses with LBD up to this one are never deleted
+
+#define BUDGET_CHECK_INTERVAL 1024 // Iterations of search loop between checks of time, memory and terminate callback
+
+#define PROBE_INTERVAL        5000   // Conflicts between probing rounds, which run at the root (after a restart in CDCL),
+                                     // doubled after each round, that fixes nothing
+#define PROBE_MIN_BUDGET      100000 // Propagations of a probing round, at least
+#define PROBE_BUDGET_RATIO    0.1    // Fraction of propagations since the previous round spent on a probing round
+
+#define GLUCOSE_RESTART_MIN_CONFLICTS  50    // Recent LBD average is not trusted before that many conflicts
+#define GLUCOSE_RESTART_MARGIN         0.8   // Restart if recent LBD average * margin exceeds the global one
+#define GLUCOSE_FAST_EMA_ALPHA         (1.0 / 32)
+
+typedef struct Implication {
+    signed int implied; // Other var of the binary clause, which becomes true once the watched one is false
+    size_t clause_num;
+} Implication;
+
+typedef struct WatchList {
+    size_t len;
+    size_t capacity;
+    size_t occurances; // Number of clauses longer than two vars with the literal, watch list never gets longer than that
+    size_t* clauses;
+    Implication* binaries; // Binary clauses with the literal, which always watch both of their vars
+    size_t binaries_len;
+    size_t binaries_capacity;
+} WatchList;
+
+typedef struct Watches {
+    size_t lits_num;
+    WatchList* lists;   // Indexed by lit_to_index(var), contains clauses that watch the literal
+    size_t* positions;  // Positions of two watched vars for each clause (2 * clause_num and 2 * clause_num + 1)
+    size_t positions_capacity;
+    size_t lists_capacity; // Sum of capacities of all watch lists
+    size_t binaries_capacity; // Sum of capacities of all binary clause lists
+} Watches;
+
+/**
+ * DPLL: number of true vars of each clause, updated on every assignment and unassignment,
+ * so the assignment is known to satisfy all clauses without rescanning them.
+ * Clauses are found by literals through an occurance index (see build_occurances), which covers clauses
+ * added to the solver only after it is rebuilt at the start of search.
+ */
+typedef struct SatCounters {
+    size_t lits_num;
+    size_t* occurance_starts;  // Clauses with the literal of index i are occurances[occurance_starts[i]..occurance_starts[i + 1])
+    size_t* occurances;
+    size_t occurances_capacity;
+    size_t* true_counts;       // Number of true vars of each indexed clause
+    size_t clauses_num;        // Number of indexed clauses
+    size_t clauses_capacity;
+    size_t sat_clauses_num;    // Number of indexed clauses with at least one true var
+} SatCounters;
+
+typedef struct ReduceCandidate {
+    size_t learnt_index;
+    size_t lbd;
+    double activity;
+} ReduceCandidate;
+
+typedef struct Solver {
+    const CNF* cnf;
+    const DpllOptions* options;
+    size_t vars_num;     // Vars of the CNF and ones added by dpll_add_vars
+    ClauseDb* db;
+    Watches* watches;
+    SatCounters* counters; // DPLL: true vars of each clause (NULL for CDCL, which checks that all vars are assigned)
+    Trail* trail;
+    size_t* reasons;     // Clause that implied each var (NO_CLAUSE for decisions and units of the CNF)
+    bool* flipped;       // DPLL: whether both branches of the decision of each level were tried
+    bool* seen;          // CDCL: vars met during conflict analysis
+    signed int* learnt;  // CDCL: learned clause being built by conflict analysis
+    double* activities;  // VSIDS: activity of each var
+    double activity_inc; // VSIDS: amount added to activity of a var involved in a conflict
+    VarHeap* heap;       // VSIDS: unassigned vars (and maybe some assigned ones) ordered by activity
+    bool* saved_phases;  // Value of each var before it was unassigned last time (initial phase until then)
+    size_t* level_stamps;           // LBD: last stamp each decision level was counted with
+    size_t level_stamp;
+    size_t conflicts_since_restart;
+    size_t luby_index;
+    double fast_lbd_average;        // Glucose restarts: exponential moving average of recent LBDs
+    double lbd_sum;                 // Glucose restarts: sum of all LBDs (for the global average)
+    double clause_activity_inc;     // Amount added to activity of a learned clause involved in a conflict
+    size_t next_reduce;             // Number of conflicts, after which learned clauses are reduced next time
+    size_t next_probe;              // Number of conflicts, after which literals are probed next time at the root
+    size_t probe_interval;          // Conflicts between probing rounds
+    size_t probe_cursor;            // Var to probe first in the next round, so rounds go around all vars
+    size_t probe_propagations;      // Propagations at the end of the previous probing round
+    bool* reduce_locked;            // Scratch of reduce_learnts, which grows with the learned clauses storage only
+    ReduceCandidate* reduce_candidates;
+    size_t* reduce_relocations;
+    size_t reduce_capacity;
+    size_t* lookahead_candidates;   // Scratch of dpll_lookahead
+    size_t lookahead_capacity;
+    uint64_t random_state;          // Xorshift state for seeded diversification
+    const signed int* assumptions;  // Literals decided before any other ones, one per level
+    size_t assumptions_num;
+    signed int* failed;             // Assumptions, that made the last dpll_solve call UNSAT
+    size_t failed_num;
+    size_t failed_capacity;
+    bool is_unsat;                  // CNF is unsatisfiable regardless of assumptions
+    struct timespec solve_start;    // Budgets are counted from the start of dpll_solve call
+    size_t start_conflicts;
+    size_t start_decisions;
+    size_t budget_countdown;        // Iterations left until the next check of expensive budgets
+    double next_progress;           // Seconds of search, after which progress is reported next time
+    DpllStats stats;
+} Solver;
 
-typedef struct ClausesList {
-    Clause* clause;
-    struct ClausesList* next;
-} ClausesList;
+static inline size_t var_to_index(signed int var) {
+    assert(var != 0);
+    return (var > 0 ? var : -var) - 1;
+}
 
-static DpllStateStack* push_dpll_state(DpllStateStack* stack, TriVector* vars_states) {
-    // stack may be null
-    assert(vars_states != NULL);
+static inline size_t lit_to_index(signed int var) {
+    assert(var != 0);
+    return trail_lit_index(var);
+}
 
-    DpllStateStack* new_stack = (DpllStateStack*) calloc(1, sizeof(DpllStateStack));
-    if (new_stack == NULL) {
-        DPLL_ERROR("Insufficient memory");
-        return NULL;
-    }
+/**
+ * Value of a literal is a single load by its index, without branching on its sign.
+ */
+static inline bool is_var_true(const unsigned char* lit_values, signed int var) {
+    assert(lit_values != NULL);
+    assert(var != 0);
 
-    new_stack->vars_states = vars_states;
-    new_stack->previous = stack;
-    return new_stack;
+    return lit_values[lit_to_index(var)] == LIT_TRUE;
 }
 
-static void pop_dpll_state(DpllStateStack** stack) {
-    assert(stack != NULL);
-    assert(*stack != NULL);
+static inline bool is_var_false(const unsigned char* lit_values, signed int var) {
+    assert(lit_values != NULL);
+    assert(var != 0);
 
-    DpllStateStack* new_stack = (*stack)->previous;
-    free(*stack);
-    *stack = new_stack;
+    return lit_values[lit_to_index(var)] == LIT_FALSE;
 }
 
-static ClausesList* list_prepend(ClausesList* item, Clause* clause) {
-    // item may be null
-    assert(clause != NULL);
+static inline void watch_list_push(WatchList* list, size_t clause_num) {
+    assert(list != NULL);
+    // Capacity is reserved for every occurance of the literal, so watch list never grows during propagation
+    assertf(list->len < list->capacity, "Watch list overflow: %zu >= %zu", list->len, list->capacity);
 
-    ClausesList* new_item = calloc(1, sizeof(ClausesList));
-    if (new_item == NULL) {
-        DPLL_ERROR("Insufficient memory");
-        return NULL;
+    list->clauses[list->len++] = clause_num;
+}
+
+static int watch_list_reserve(Watches* watches, WatchList* list, size_t capacity) {
+    assert(watches != NULL);
+    assert(list != NULL);
+
+    if (capacity <= list->capacity) {
+        return 0;
     }
 
-    new_item->clause = clause;
-    new_item->next = item;
-    return new_item;
+    size_t new_capacity = list->capacity < 4 ? 4 : list->capacity;
+    while (new_capacity < capacity) {
+        new_capacity *= 2;
+    }
+    size_t* new_clauses = (size_t*) realloc(list->clauses, new_capacity * sizeof(size_t));
+    if (new_clauses == NULL) {
+        return -1;
+    }
+    watches->lists_capacity += new_capacity - list->capacity;
+    list->clauses = new_clauses;
+    list->capacity = new_capacity;
+    return 0;
 }
 
-static void list_drop_current(ClausesList** item) {
-    assert(item != NULL);
-    assert(*item != NULL);
+static int watch_binaries_reserve(Watches* watches, WatchList* list, size_t capacity) {
+    assert(watches != NULL);
+    assert(list != NULL);
+
+    if (capacity <= list->binaries_capacity) {
+        return 0;
+    }
 
-    ClausesList* next = (*item)->next;
-    free(*item);
-    *item = next;
+    size_t new_capacity = list->binaries_capacity < 4 ? 4 : list->binaries_capacity;
+    while (new_capacity < capacity) {
+        new_capacity *= 2;
+    }
+    Implication* new_binaries = (Implication*) realloc(list->binaries, new_capacity * sizeof(Implication));
+    if (new_binaries == NULL) {
+        return -1;
+    }
+    watches->binaries_capacity += new_capacity - list->binaries_capacity;
+    list->binaries = new_binaries;
+    list->binaries_capacity = new_capacity;
+    return 0;
 }
 
-static inline size_t var_to_index(signed int var) {
-    assert(var != 0);
-    return (var > 0 ? var : -var) - 1;
+static inline void watch_binary_push(WatchList* list, signed int implied, size_t clause_num) {
+    assert(list != NULL);
+    assertf(list->binaries_len < list->binaries_capacity, "Binary list overflow: %zu >= %zu", list->binaries_len, list->binaries_capacity);
+
+    list->binaries[list->binaries_len].implied = implied;
+    list->binaries[list->binaries_len].clause_num = clause_num;
+    ++list->binaries_len;
 }
 
-static ClausesList** create_occurance_list(
-    const CNF* cnf,
-    bool for_positive_vars
-) {
+/**
+ * Number of clauses with the literal, binary ones included.
+ */
+static inline size_t lit_occurances(const WatchList* list) {
+    assert(list != NULL);
+
+    return list->occurances + list->binaries_len;
+}
+
+static void free_watches(Watches* watches) {
+    if (watches != NULL) {
+        if (watches->lists != NULL) {
+            for (size_t i = 0; i < watches->lits_num; ++i) {
+                free(watches->lists[i].clauses);
+                free(watches->lists[i].binaries);
+            }
+        }
+        free(watches->lists);
+        free(watches->positions);
+        free(watches);
+    }
+}
+
+static Watches* create_watches(const CNF* cnf) {
     assert(cnf != NULL);
 
-    size_t vars_num = cnf->vars_num;
-    ClausesList** vars_lists = calloc(vars_num, sizeof(ClausesList*));
-    if (vars_lists == NULL) {
+    Clause* clauses = cnf->clauses;
+    size_t clauses_num = cnf->clauses_num;
+    size_t lits_num = 2 * cnf->vars_num;
+
+    Watches* watches = (Watches*) calloc(1, sizeof(Watches));
+    if (watches == NULL) {
         DPLL_ERROR("Insufficient memory");
         goto error;
     }
+    watches->lits_num = lits_num;
 
-    Clause** clauses = cnf->clauses;
-    size_t clauses_num = cnf->clauses_num;
+    watches->lists = (WatchList*) calloc(lits_num, sizeof(WatchList));
+    watches->positions_capacity = 2 * clauses_num + 2;
+    watches->positions = (size_t*) calloc(watches->positions_capacity, sizeof(size_t));
+    if (watches->lists == NULL || watches->positions == NULL) {
+        DPLL_ERROR("Insufficient memory");
+        goto error;
+    }
+
+    // Binary clause lists are counted in binaries_len first, which is reset once they are reserved
     for (size_t clause_num = 0; clause_num < clauses_num; ++clause_num) {
-        Clause* clause = clauses[clause_num];
-        size_t len = clause->len;
-        signed int* vars = clause->vars;
-        signed int undecided_var = 0;
-        for (size_t var_num = 0; var_num < len; ++var_num) {
-            signed int var = vars[var_num];
-            assert(var != 0);
-            if (for_positive_vars && var > 0 || !for_positive_vars && var < 0) {
-                size_t var_index = var_to_index(var);
-                ClausesList* new_var_list = list_prepend(vars_lists[var_index], clause);
-                if (new_var_list == NULL) {
-                    DPLL_ERROR("Insufficient memory");
-                    goto error;
-                }
-                vars_lists[var_index] = new_var_list;
+        Clause* clause = &clauses[clause_num];
+        signed int* vars = cnf_clause_vars(cnf, clause);
+        for (size_t var_num = 0; var_num < clause->len; ++var_num) {
+            WatchList* list = &watches->lists[lit_to_index(vars[var_num])];
+            if (clause->len == 2) {
+                ++list->binaries_len;
+            } else {
+                ++list->occurances;
             }
         }
     }
+    for (size_t i = 0; i < lits_num; ++i) {
+        WatchList* list = &watches->lists[i];
+        if (watch_list_reserve(watches, list, list->occurances) != 0
+            || watch_binaries_reserve(watches, list, list->binaries_len) != 0) {
+            DPLL_ERROR("Insufficient memory");
+            goto error;
+        }
+        list->binaries_len = 0;
+    }
+
+    for (size_t clause_num = 0; clause_num < clauses_num; ++clause_num) {
+        Clause* clause = &clauses[clause_num];
+        if (clause->len < 2) {
+            // Empty and unit clauses are handled by propagate_all_units
+            continue;
+        }
+        signed int* vars = cnf_clause_vars(cnf, clause);
+        if (clause->len == 2) {
+            watch_binary_push(&watches->lists[lit_to_index(vars[0])], vars[1], clause_num);
+            watch_binary_push(&watches->lists[lit_to_index(vars[1])], vars[0], clause_num);
+            continue;
+        }
+        watches->positions[2 * clause_num] = 0;
+        watches->positions[2 * clause_num + 1] = 1;
+        watch_list_push(&watches->lists[lit_to_index(vars[0])], clause_num);
+        watch_list_push(&watches->lists[lit_to_index(vars[1])], clause_num);
+    }
 
-    return vars_lists;
+    return watches;
 
 error:
-    if (vars_lists != NULL) {
-        for (size_t i = 0; i < vars_num; ++i) {
-            while (vars_lists[i] != NULL) {
-                list_drop_current(&vars_lists[i]);
-            }
+    free_watches(watches);
+    return NULL;
+}
+
+/**
+ * Starts watching the first two vars of a new clause (which should have at least two vars).
+ * Binary clauses go to binary clause lists of both vars instead.
+ */
+static int watch_new_clause(
+    Watches* watches,
+    size_t clause_num,
+    const signed int* vars,
+    size_t len
+) {
+    assert(watches != NULL);
+    assert(vars != NULL);
+    assert(len >= 2);
+
+    if (2 * clause_num + 2 > watches->positions_capacity) {
+        size_t new_capacity = 2 * watches->positions_capacity;
+        size_t* new_positions = (size_t*) realloc(watches->positions, new_capacity * sizeof(size_t));
+        if (new_positions == NULL) {
+            DPLL_ERROR("Insufficient memory");
+            return -1;
         }
-        free(vars_lists);
+        watches->positions = new_positions;
+        watches->positions_capacity = new_capacity;
     }
-    return NULL;
+
+    if (len == 2) {
+        WatchList* first = &watches->lists[lit_to_index(vars[0])];
+        WatchList* second = &watches->lists[lit_to_index(vars[1])];
+        if (watch_binaries_reserve(watches, first, first->binaries_len + 1) != 0
+            || watch_binaries_reserve(watches, second, second->binaries_len + 1) != 0) {
+            DPLL_ERROR("Insufficient memory");
+            return -1;
+        }
+        watch_binary_push(first, vars[1], clause_num);
+        watch_binary_push(second, vars[0], clause_num);
+        return 0;
+    }
+
+    for (size_t var_num = 0; var_num < len; ++var_num) {
+        WatchList* list = &watches->lists[lit_to_index(vars[var_num])];
+        if (watch_list_reserve(watches, list, list->occurances + 1) != 0) {
+            DPLL_ERROR("Insufficient memory");
+            return -1;
+        }
+        ++list->occurances;
+    }
+
+    watches->positions[2 * clause_num] = 0;
+    watches->positions[2 * clause_num + 1] = 1;
+    watch_list_push(&watches->lists[lit_to_index(vars[0])], clause_num);
+    watch_list_push(&watches->lists[lit_to_index(vars[1])], clause_num);
+    return 0;
+}
+
+static void free_sat_counters(SatCounters* counters) {
+    if (counters != NULL) {
+        free(counters->occurance_starts);
+        free(counters->occurances);
+        free(counters->true_counts);
+        free(counters);
+    }
+}
+
+static const signed int* db_clause_vars(const void* db, size_t clause_num, size_t* len) {
+    return clausedb_clause_vars((const ClauseDb*) db, clause_num, len);
+}
+
+/**
+ * Indexes all clauses of the database and counts their true vars under the given literal values.
+ */
+static int index_sat_counters(SatCounters* counters, const ClauseDb* db, const unsigned char* lit_values) {
+    assert(counters != NULL);
+    assert(db != NULL);
+    assert(lit_values != NULL);
+
+    size_t clauses_num = clausedb_clauses_num(db);
+    size_t occurances_num = db->cnf->vars_len + db->vars_len;
+    if (clauses_num > counters->clauses_capacity) {
+        size_t* true_counts = (size_t*) realloc(counters->true_counts, clauses_num * sizeof(size_t));
+        if (true_counts == NULL) {
+            DPLL_ERROR("Insufficient memory");
+            return -1;
+        }
+        counters->true_counts = true_counts;
+        counters->clauses_capacity = clauses_num;
+    }
+    if (occurances_num > counters->occurances_capacity) {
+        size_t* occurances = (size_t*) realloc(counters->occurances, occurances_num * sizeof(size_t));
+        if (occurances == NULL) {
+            DPLL_ERROR("Insufficient memory");
+            return -1;
+        }
+        counters->occurances = occurances;
+        counters->occurances_capacity = occurances_num;
+    }
+    build_occurances(db, clauses_num, db_clause_vars, counters->lits_num, counters->occurance_starts, counters->occurances);
+
+    size_t sat_clauses_num = 0;
+    for (size_t clause_num = 0; clause_num < clauses_num; ++clause_num) {
+        size_t len = 0;
+        const signed int* vars = clausedb_clause_vars(db, clause_num, &len);
+        size_t true_count = 0;
+        for (size_t var_num = 0; var_num < len; ++var_num) {
+            true_count += is_var_true(lit_values, vars[var_num]) ? 1 : 0;
+        }
+        counters->true_counts[clause_num] = true_count;
+        sat_clauses_num += true_count > 0 ? 1 : 0;
+    }
+    counters->clauses_num = clauses_num;
+    counters->sat_clauses_num = sat_clauses_num;
+    return 0;
+}
+
+/**
+ * Creates counters of the given literals number, which index clauses only once index_sat_counters is called.
+ */
+static SatCounters* create_sat_counters(size_t lits_num) {
+    SatCounters* counters = (SatCounters*) calloc(1, sizeof(SatCounters));
+    if (counters == NULL) {
+        DPLL_ERROR("Insufficient memory");
+        return NULL;
+    }
+    counters->lits_num = lits_num;
+    counters->occurance_starts = (size_t*) calloc(lits_num + 1, sizeof(size_t));
+    if (counters->occurance_starts == NULL) {
+        DPLL_ERROR("Insufficient memory");
+        free_sat_counters(counters);
+        return NULL;
+    }
+    return counters;
+}
+
+static inline void sat_counters_assign(SatCounters* counters, signed int var) {
+    assert(counters != NULL);
+
+    size_t lit_index = lit_to_index(var);
+    const size_t* occurances = counters->occurances;
+    size_t* true_counts = counters->true_counts;
+    size_t newly_sat = 0;
+    for (size_t i = counters->occurance_starts[lit_index], end = counters->occurance_starts[lit_index + 1]; i < end; ++i) {
+        newly_sat += true_counts[occurances[i]]++ == 0 ? 1 : 0;
+    }
+    counters->sat_clauses_num += newly_sat;
+}
+
+static inline void sat_counters_unassign(SatCounters* counters, signed int var) {
+    assert(counters != NULL);
+
+    size_t lit_index = lit_to_index(var);
+    const size_t* occurances = counters->occurances;
+    size_t* true_counts = counters->true_counts;
+    size_t no_longer_sat = 0;
+    for (size_t i = counters->occurance_starts[lit_index], end = counters->occurance_starts[lit_index + 1]; i < end; ++i) {
+        assert(true_counts[occurances[i]] > 0);
+        no_longer_sat += --true_counts[occurances[i]] == 0 ? 1 : 0;
+    }
+    counters->sat_clauses_num -= no_longer_sat;
 }
 
+#ifndef NDEBUG
+// Full rescans of the clauses, which only check the incremental state in assertions
+
 static bool is_definitely_sat_clause(
-    const Clause* clause,
-    const TriVector* vars_states
+    const signed int* vars,
+    size_t len,
+    const unsigned char* lit_values
 ) {
-    assert(clause != NULL);
-    assert(vars_states != NULL);
+    assert(vars != NULL || len == 0);
+    assert(lit_values != NULL);
 
-    signed int* vars = clause->vars;
-    for (size_t var_num = 0, len = clause->len; var_num < len; ++var_num) {
+    for (size_t var_num = 0; var_num < len; ++var_num) {
         signed int var = vars[var_num];
-        assert(var != 0);
-        if (var > 0) {
-            if (trivector_is_set_true(vars_states, var_to_index(var))) {
-                return true;
-            }
-        } else {
-            if (trivector_is_set_false(vars_states, var_to_index(var))) {
-                return true;
-            }
+        if (is_var_true(lit_values, var)) {
+            return true;
         }
     }
-    return false; 
+    return false;
 }
 
 static bool is_definitely_unsat_clause(
-    const Clause* clause,
-    const TriVector* vars_states
+    const signed int* vars,
+    size_t len,
+    const unsigned char* lit_values
 ) {
-    assert(clause != NULL);
-    assert(vars_states != NULL);
+    assert(vars != NULL || len == 0);
+    assert(lit_values != NULL);
 
-    signed int* vars = clause->vars;
-    for (size_t var_num = 0, len = clause->len; var_num < len; ++var_num) {
+    for (size_t var_num = 0; var_num < len; ++var_num) {
         signed int var = vars[var_num];
-        assert(var != 0);
-        if (var > 0) {
-            if (!trivector_is_set_false(vars_states, var_to_index(var))) {
-                return false;
-            }
-        } else {
-            if (!trivector_is_set_true(vars_states, var_to_index(var))) {
-                return false;
-            }
+        if (!is_var_false(lit_values, var)) {
+            return false;
         }
     }
     return true;
 }
 
+/**
+ * Clauses of the CNF and learned or added ones (DPLL never learns, so it only has added ones).
+ */
 static bool is_definitely_sat(
-    const CNF* cnf,
-    const TriVector* vars_states
+    const ClauseDb* db,
+    const unsigned char* lit_values
 ) {
-    assert(cnf != NULL);
-    assert(vars_states != NULL);
+    assert(db != NULL);
+    assert(lit_values != NULL);
 
-    Clause** clauses = cnf->clauses;
+    const CNF* cnf = db->cnf;
     for (size_t clause_num = 0, clauses_num = cnf->clauses_num; clause_num < clauses_num; ++clause_num) {
-        if (!is_definitely_sat_clause(clauses[clause_num], vars_states)) {
-           return false; 
+        const Clause* clause = &cnf->clauses[clause_num];
+        if (!is_definitely_sat_clause(cnf_clause_vars(cnf, clause), clause->len, lit_values)) {
+           return false;
+        }
+    }
+    for (size_t i = 0, learnts_num = db->learnts_num; i < learnts_num; ++i) {
+        const LearntClause* clause = &db->learnts[i];
+        if (!is_definitely_sat_clause(db->vars + clause->offset, clause->len, lit_values)) {
+           return false;
         }
     }
     return true;
 }
 
 static bool is_definitely_unsat(
-    const CNF* cnf,
-    const TriVector* vars_states
+    const ClauseDb* db,
+    const unsigned char* lit_values
 ) {
-    assert(cnf != NULL);
-    assert(vars_states != NULL);
+    assert(db != NULL);
+    assert(lit_values != NULL);
 
-    Clause** clauses = cnf->clauses;
+    const CNF* cnf = db->cnf;
     for (size_t clause_num = 0, clauses_num = cnf->clauses_num; clause_num < clauses_num; ++clause_num) {
-        if (is_definitely_unsat_clause(clauses[clause_num], vars_states)) {
+        const Clause* clause = &cnf->clauses[clause_num];
+        if (is_definitely_unsat_clause(cnf_clause_vars(cnf, clause), clause->len, lit_values)) {
+            return true;
+        }
+    }
+    for (size_t i = 0, learnts_num = db->learnts_num; i < learnts_num; ++i) {
+        const LearntClause* clause = &db->learnts[i];
+        if (is_definitely_unsat_clause(db->vars + clause->offset, clause->len, lit_values)) {
             return true;
         }
     }
@@ -207,304 +566,1593 @@ static bool is_definitely_unsat(
 }
 
 static bool has_contradictions(
-    const CNF* cnf,
-    const TriVector* vars_states
+    const ClauseDb* db,
+    const unsigned char* lit_values
 ) {
-    assert(cnf != NULL);
-    assert(vars_states != NULL);
+    assert(db != NULL);
+    assert(lit_values != NULL);
 
-    return is_definitely_unsat(cnf, vars_states);
+    return is_definitely_unsat(db, lit_values);
 }
 
-static signed int get_single_undecided_var_or_zero(
-    const Clause* clause,
-    const TriVector* vars_states
-) {
-    assert(clause != NULL);
-    assert(vars_states != NULL);
+#endif
 
-    size_t len = clause->len;
-    signed int* vars = clause->vars;
-    signed int undecided_var = 0;
-    for (size_t var_num = 0; var_num < len; ++var_num) {
-        signed int var = vars[var_num];
-        assert(var != 0);
-        if (var > 0) {
-            if (trivector_is_set_true(vars_states, var_to_index(var))) {
-                // This clause is already SAT
-                return 0;
-            }
-            if (!trivector_is_set_false(vars_states, var_to_index(var))) {
-                if (undecided_var != 0) {
-                    // There are at least two undecided vars
-                    return 0;
-                }
-                undecided_var = var;
-            }
-        } else {
-            if (trivector_is_set_false(vars_states, var_to_index(var))) {
-                // This clause is already SAT
-                return 0;
-            }
-            if (!trivector_is_set_true(vars_states, var_to_index(var))) {
-                if (undecided_var != 0) {
-                    // There are at least two undecided vars
-                    return 0;
-                }
-                undecided_var = var;
-            }
-        }
+static inline void assign_var(Solver* solver, signed int var, size_t reason) {
+    assert(solver != NULL);
+    assert(var != 0);
+
+    solver->reasons[var_to_index(var)] = reason;
+    trail_assign(solver->trail, var);
+    if (solver->counters != NULL) {
+        sat_counters_assign(solver->counters, var);
     }
-    return undecided_var;
 }
 
-static void propagate_all_units(
-    const CNF* cnf,
-    TriVector* vars_states
-) {
-    assert(cnf != NULL);
-    assert(vars_states != NULL);
+static void bump_var_activity(Solver* solver, size_t var_index) {
+    assert(solver != NULL);
 
-    Clause** clauses = cnf->clauses;
-    size_t clauses_num = cnf->clauses_num;
+    double* activities = solver->activities;
+    activities[var_index] += solver->activity_inc;
+    if (activities[var_index] > VSIDS_RESCALE_LIMIT) {
+        // Relative order is all that matters, so scale everything down before overflow
+        for (size_t i = 0, vars_num = solver->vars_num; i < vars_num; ++i) {
+            activities[i] /= VSIDS_RESCALE_LIMIT;
+        }
+        solver->activity_inc /= VSIDS_RESCALE_LIMIT;
+    }
+    var_heap_increased(solver->heap, var_index);
+}
 
-    bool any_changes = false;
-    do {
-        any_changes = false;
-        for (size_t clause_num = 0; clause_num < clauses_num; ++clause_num) {
-            signed int undecided_var = get_single_undecided_var_or_zero(clauses[clause_num], vars_states);
-            if (undecided_var != 0) {
-                size_t var_index = var_to_index(undecided_var);
-                assert(trivector_is_not_set(vars_states, var_index));
+static inline void decay_var_activities(Solver* solver) {
+    assert(solver != NULL);
 
-                trivector_set(vars_states, var_index, undecided_var > 0);
-                any_changes = true;
-            }
-        }
-    } while (any_changes);
+    // Instead of decaying all activities, bump future conflicts more (EVSIDS)
+    solver->activity_inc /= VSIDS_DECAY;
 }
 
-static void propagate_units_for_toggled_var(
-    const CNF* cnf,
-    TriVector* vars_states,
-    ClausesList** positive_occurance_list,
-    ClausesList** negative_occurance_list,
-    size_t toggled_var_index,
-    bool is_positive
-) {
-    assert(cnf != NULL);
-    assert(vars_states != NULL);
-    assert(positive_occurance_list != NULL);
-    assert(negative_occurance_list != NULL);
-    assert(positive_occurance_list != negative_occurance_list);
+static void bump_clause_activity(Solver* solver, size_t clause_num) {
+    assert(solver != NULL);
 
-    size_t vars_num = cnf->vars_num;
-    ClausesList** clauses_to_process = (ClausesList**) calloc(vars_num, sizeof(ClausesList*));
-    if (clauses_to_process == NULL) {
-        DPLL_ERROR("Insufficient memory");
-        return; // TODO: Pass error to caller?
+    ClauseDb* db = solver->db;
+    if (!clausedb_is_learnt(db, clause_num)) {
+        return;
     }
-
-    if (is_positive) {
-        clauses_to_process[toggled_var_index] = negative_occurance_list[toggled_var_index];
-    } else {
-        clauses_to_process[toggled_var_index] = positive_occurance_list[toggled_var_index];
+    LearntClause* clause = clausedb_learnt(db, clause_num);
+    clause->activity += solver->clause_activity_inc;
+    if (clause->activity > CLAUSE_RESCALE_LIMIT) {
+        for (size_t i = 0, learnts_num = db->learnts_num; i < learnts_num; ++i) {
+            db->learnts[i].activity /= CLAUSE_RESCALE_LIMIT;
+        }
+        solver->clause_activity_inc /= CLAUSE_RESCALE_LIMIT;
     }
+}
 
-    bool any_changes = false;
-    do {
-        any_changes = false;
-        for (size_t i = 0; i < vars_num; ++i) {
-            ClausesList* current_list_item = clauses_to_process[i];
-            clauses_to_process[i] = NULL;
-            while (current_list_item != NULL) {
-                signed int undecided_var = get_single_undecided_var_or_zero(current_list_item->clause, vars_states);
-                if (undecided_var != 0) {
-                    size_t var_index = var_to_index(undecided_var);
-                    assert(trivector_is_not_set(vars_states, var_index));
-
-                    if (undecided_var > 0) {
-                        trivector_set(vars_states, var_index, true);
-                        clauses_to_process[var_index] = negative_occurance_list[var_index];
-                    } else {
-                        trivector_set(vars_states, var_index, false);
-                        clauses_to_process[var_index] = positive_occurance_list[var_index];
-                    }
-                    any_changes = true;
-                }
-                current_list_item = current_list_item->next;
-            }
-        }
-    } while (any_changes);
+static uint64_t next_random(Solver* solver) {
+    assert(solver != NULL);
 
-    free(clauses_to_process);
+    uint64_t x = solver->random_state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    solver->random_state = x;
+    return x * 0x2545F4914F6CDD1DULL;
 }
 
-static size_t choose_var(
-    const CNF* cnf,
-    const TriVector* vars_states
-) {
-    assert(cnf != NULL);
-    assert(vars_states != NULL);
+/**
+ * Bytes allocated by the solver itself and by the CNF it solves.
+ */
+static size_t memory_usage(const Solver* solver) {
+    assert(solver != NULL);
+
+    const CNF* cnf = solver->cnf;
+    const ClauseDb* db = solver->db;
+    const Watches* watches = solver->watches;
+    size_t vars_num = solver->vars_num + 1;
+    size_t levels_num = solver->trail->levels_capacity + 1;
+    size_t per_var = sizeof(size_t) + sizeof(bool) + sizeof(signed int) + sizeof(double) + sizeof(bool)  // Solver
+        + sizeof(signed int) + sizeof(size_t)                                                             // Trail
+        + 2 * sizeof(size_t)                                                                              // Heap
+        + 2 * sizeof(WatchList);
+    size_t per_level = sizeof(bool) + 2 * sizeof(size_t);
+    size_t structs = sizeof(Solver) + sizeof(ClauseDb) + sizeof(Watches) + sizeof(Trail) + sizeof(TriVector) + sizeof(VarHeap)
+        + (solver->counters != NULL ? sizeof(SatCounters) : 0);
+    return structs + vars_num * per_var + levels_num * per_level
+        + cnf->clauses_num * sizeof(Clause) + cnf->vars_len * sizeof(signed int)
+        + db->learnts_capacity * sizeof(LearntClause) + db->vars_capacity * sizeof(signed int)
+        + (watches->positions_capacity + watches->lists_capacity) * sizeof(size_t)
+        + watches->binaries_capacity * sizeof(Implication)
+        + solver->failed_capacity * sizeof(signed int)
+        + (solver->counters != NULL
+            ? (solver->counters->lits_num + 1 + solver->counters->occurances_capacity + solver->counters->clauses_capacity)
+                * sizeof(size_t)
+            : 0)
+        + solver->trail->vars_states->words_num * sizeof(uint64_t)
+        + 2 * vars_num * sizeof(unsigned char)
+        + solver->reduce_capacity * (sizeof(bool) + sizeof(ReduceCandidate) + sizeof(size_t))
+        + solver->lookahead_capacity * sizeof(size_t);
+}
 
-    size_t var = trivector_index_of_not_set(vars_states);
+static double solve_seconds(const Solver* solver) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) (now.tv_sec - solver->solve_start.tv_sec) + (double) (now.tv_nsec - solver->solve_start.tv_nsec) / 1e9;
+}
 
-    assert(var >= cnf->vars_num || trivector_is_not_set(vars_states, var));
-    return var;
+static void update_peak_memory(Solver* solver) {
+    assert(solver != NULL);
+
+    size_t memory = memory_usage(solver);
+    if (memory > solver->stats.peak_memory) {
+        solver->stats.peak_memory = memory;
+    }
 }
 
-static DpllStateStack* var_branching(
-    const CNF* cnf,
-    TriVector* vars_states,
-    DpllStateStack* cur_state,
-    ClausesList** positive_occurance_list,
-    ClausesList** negative_occurance_list,
-    size_t toggled_var
-) {
-    assert(cnf != NULL);
-    assert(vars_states != NULL);
-    // cur_state may be null
-    assert(positive_occurance_list != NULL);
-    assert(negative_occurance_list != NULL);
-    assert(positive_occurance_list != negative_occurance_list);
-    assert(toggled_var < cnf->vars_num);
+/**
+ * Reports progress, if its interval is over. Search time of the previous calls is counted too.
+ */
+static void report_progress(Solver* solver, double seconds) {
+    assert(solver != NULL);
 
-    DpllStateStack* new_state = NULL;
+    const DpllOptions* options = solver->options;
+    double search_time = solver->stats.search_time + seconds;
+    if (search_time < solver->next_progress) {
+        return;
+    }
+    solver->next_progress = search_time + options->progress_interval;
+    DpllStats stats = solver->stats;
+    stats.search_time = search_time;
+    options->progress(&stats, options->progress_data);
+}
 
-    TriVector* vars_states_left = clone_trivector(vars_states);
-    if (vars_states_left == NULL) {
-        DPLL_ERROR("Insufficient memory");
-        return NULL;
+/**
+ * Checks, whether search was cancelled or exhausted one of its budgets. Counters are checked every time,
+ * while clock, memory and terminate callback are checked (and progress is reported) once per BUDGET_CHECK_INTERVAL calls.
+ */
+static bool should_stop(Solver* solver) {
+    assert(solver != NULL);
+
+    const DpllOptions* options = solver->options;
+    if (options->cancelled != NULL && atomic_load_explicit(options->cancelled, memory_order_relaxed)) {
+        return true;
     }
-    trivector_set(vars_states_left, toggled_var, false);
-    propagate_units_for_toggled_var(cnf, vars_states_left, positive_occurance_list, negative_occurance_list, toggled_var, false);
-    new_state = push_dpll_state(cur_state, vars_states_left);
-    if (new_state == NULL) {
-        DPLL_ERROR("Insufficient memory");
-        free_trivector(vars_states_left);
-        return NULL;
+    if ((options->conflicts_limit > 0 && solver->stats.conflicts - solver->start_conflicts >= options->conflicts_limit)
+        || (options->decisions_limit > 0 && solver->stats.decisions - solver->start_decisions >= options->decisions_limit)) {
+        return true;
     }
-    cur_state = new_state;
-    new_state = NULL;
-
-    TriVector* vars_states_right = clone_trivector(vars_states);
-    if (vars_states_right == NULL) {
-        DPLL_ERROR("Insufficient memory");
-        free_trivector(vars_states_left);
-        pop_dpll_state(&cur_state);
-        return NULL;
+    // Accounting is a few additions, so memory is checked every time: search stops before the next growth
+    if (options->memory_limit > 0 && memory_usage(solver) > options->memory_limit) {
+        update_peak_memory(solver);
+        return true;
     }
-    trivector_set(vars_states_right, toggled_var, true);
-    propagate_units_for_toggled_var(cnf, vars_states_right, positive_occurance_list, negative_occurance_list, toggled_var, true);
-    new_state = push_dpll_state(cur_state, vars_states_right);
-    if (new_state == NULL) {
-        DPLL_ERROR("Insufficient memory");
-        free_trivector(vars_states_left);
-        free_trivector(vars_states_right);
-        pop_dpll_state(&cur_state);
-        return NULL;
+    if (--solver->budget_countdown > 0) {
+        return false;
     }
-
-    return new_state;
+    solver->budget_countdown = BUDGET_CHECK_INTERVAL;
+    update_peak_memory(solver);
+    double seconds = options->time_limit > 0.0 || options->progress != NULL ? solve_seconds(solver) : 0.0;
+    if (options->progress != NULL) {
+        report_progress(solver, seconds);
+    }
+    return (options->terminate != NULL && options->terminate(options->terminate_data) != 0)
+        || (options->time_limit > 0.0 && seconds >= options->time_limit);
 }
 
-DpllResult dpll_check_sat(const CNF* cnf) {
-    assert(cnf != NULL);
-
-    TriVector* vars_states = NULL;
-    DpllStateStack* cur_state = NULL;
-    ClausesList** positive_occurance_list = NULL;
-    ClausesList** negative_occurance_list = NULL;
-    DpllResult result = ERROR;
+/**
+ * Opens the next decision level.
+ */
+static inline void new_level(Solver* solver) {
+    assert(solver != NULL);
 
-    vars_states = create_trivector(cnf->vars_num);
-    if (vars_states == NULL) {
-        DPLL_ERROR("Insufficient memory");
-        result = ERROR;
-        goto exit;
+    Trail* trail = solver->trail;
+    trail_new_level(trail);
+    if (trail->levels_num > solver->stats.max_depth) {
+        solver->stats.max_depth = trail->levels_num;
     }
+}
 
-    positive_occurance_list = create_occurance_list(cnf, true);
-    if (positive_occurance_list == NULL) {
-        DPLL_ERROR("Insufficient memory");
-        result = ERROR;
-        goto exit;
-    }
+static inline void decay_clause_activities(Solver* solver) {
+    assert(solver != NULL);
 
-    negative_occurance_list = create_occurance_list(cnf, false);
-    if (negative_occurance_list == NULL) {
-        DPLL_ERROR("Insufficient memory");
-        result = ERROR;
-        goto exit;
-    }
+    solver->clause_activity_inc /= CLAUSE_ACTIVITY_DECAY;
+}
 
-    propagate_all_units(cnf, vars_states);
+/**
+ * Unassigns all vars of levels above the given one and returns them to the branching heap.
+ */
+static inline void unassign_levels(Solver* solver, size_t level, bool save_phases) {
+    assert(solver != NULL);
 
-    cur_state = push_dpll_state(cur_state, vars_states);
-    if (cur_state == NULL) {
-        DPLL_ERROR("Insufficient memory");
-        result = ERROR;
-        goto exit;
+    Trail* trail = solver->trail;
+    if (level >= trail->levels_num) {
+        return;
+    }
+    for (size_t i = trail->level_starts[level], len = trail->len; i < len; ++i) {
+        signed int var = trail->vars[i];
+        if (save_phases) {
+            solver->saved_phases[var_to_index(var)] = var > 0;
+        }
+        var_heap_insert(solver->heap, var_to_index(var));
+        if (solver->counters != NULL) {
+            sat_counters_unassign(solver->counters, var);
+        }
     }
+    trail_backtrack(trail, level);
+}
 
-    while (cur_state != NULL) {
-        vars_states = cur_state->vars_states;
-        pop_dpll_state(&cur_state);
+static void backtrack_to(Solver* solver, size_t level) {
+    unassign_levels(solver, level, solver->options->phase_saving);
+}
 
-        if (is_definitely_sat(cnf, vars_states)) {
-            result = SAT;
-            goto exit;
+/**
+ * Propagates units implied by the assigned, but not yet propagated vars of the trail.
+ * Only clauses that watch the negation of such var are visited, binary ones first: they imply
+ * the other var stored in the list without looking into the clause.
+ * Returns the clause that became unsatisfiable (remaining vars are left unpropagated) or NO_CLAUSE.
+ */
+static size_t propagate_units(Solver* solver) {
+    assert(solver != NULL);
+
+    const ClauseDb* db = solver->db;
+    Trail* trail = solver->trail;
+    Watches* watches = solver->watches;
+    size_t* positions = watches->positions;
+    unsigned char* lit_values = trail->lit_values;
+    while (trail->propagated < trail->len) {
+        signed int false_var = -trail->vars[trail->propagated++];
+        assert(is_var_false(lit_values, false_var));
+        ++solver->stats.propagations;
+
+        WatchList* list = &watches->lists[lit_to_index(false_var)];
+        const Implication* binaries = list->binaries;
+        for (size_t i = 0, len = list->binaries_len; i < len; ++i) {
+            signed int implied = binaries[i].implied;
+            if (is_var_true(lit_values, implied)) {
+                continue;
+            }
+            if (is_var_false(lit_values, implied)) {
+                return binaries[i].clause_num;
+            }
+            assign_var(solver, implied, binaries[i].clause_num);
         }
 
-        if (has_contradictions(cnf, vars_states)) {
-            free_trivector(vars_states);
-            vars_states = NULL;
-            continue;
-        }
+        size_t* watching = list->clauses;
+        size_t kept = 0;
+        for (size_t i = 0, len = list->len; i < len; ++i) {
+            size_t clause_num = watching[i];
+            size_t clause_len = 0;
+            const signed int* vars = clausedb_clause_vars(db, clause_num, &clause_len);
+            size_t* clause_positions = positions + 2 * clause_num;
+            size_t false_slot = vars[clause_positions[0]] == false_var ? 0 : 1;
+            assert(vars[clause_positions[false_slot]] == false_var);
+
+            signed int other_var = vars[clause_positions[1 - false_slot]];
+            if (is_var_true(lit_values, other_var)) {
+                // Clause is already SAT
+                watching[kept++] = clause_num;
+                continue;
+            }
 
-        size_t toggled_var = choose_var(cnf, vars_states);
-        if (toggled_var >= cnf->vars_num) {
-            result = SAT;
-            goto exit;
-        }
+            bool moved = false;
+            for (size_t var_num = 0; var_num < clause_len; ++var_num) {
+                if (var_num == clause_positions[0] || var_num == clause_positions[1]) {
+                    continue;
+                }
+                signed int var = vars[var_num];
+                if (!is_var_false(lit_values, var)) {
+                    clause_positions[false_slot] = var_num;
+                    watch_list_push(&watches->lists[lit_to_index(var)], clause_num);
+                    moved = true;
+                    break;
+                }
+            }
+            if (moved) {
+                continue;
+            }
 
-        DpllStateStack* new_state = var_branching(cnf, vars_states, cur_state, positive_occurance_list, negative_occurance_list, toggled_var);
-        if (new_state == NULL) {
-            DPLL_ERROR("Insufficient memory");
-            result = ERROR;
-            goto exit;
-        }
-        cur_state = new_state;
-        new_state = NULL;
+            watching[kept++] = clause_num;
+            if (is_var_false(lit_values, other_var)) {
+                // All vars are false - contradiction
+                for (++i; i < len; ++i) {
+                    watching[kept++] = watching[i];
+                }
+                list->len = kept;
+                return clause_num;
+            }
 
-        free_trivector(vars_states);
-        vars_states = NULL;
+            // Clause became unit
+            assign_var(solver, other_var, clause_num);
+        }
+        list->len = kept;
     }
+    return NO_CLAUSE;
+}
 
-    result = UNSAT;
+static bool propagate_all_units(Solver* solver) {
+    assert(solver != NULL);
+    assert(solver->trail->levels_num == 0);
 
-exit:
-    free_trivector(vars_states);
-    if (positive_occurance_list != NULL) {
-        for (size_t i = 0, vars_num = cnf->vars_num; i < vars_num; ++i) {
-            while (positive_occurance_list[i] != NULL) {
-                list_drop_current(&positive_occurance_list[i]);
+    const CNF* cnf = solver->cnf;
+    const unsigned char* lit_values = solver->trail->lit_values;
+    Clause* clauses = cnf->clauses;
+    for (size_t clause_num = 0, clauses_num = cnf->clauses_num; clause_num < clauses_num; ++clause_num) {
+        Clause* clause = &clauses[clause_num];
+        if (clause->len == 0) {
+            return false;
+        }
+        if (clause->len == 1) {
+            signed int var = cnf_clause_vars(cnf, clause)[0];
+            if (is_var_false(lit_values, var)) {
+                return false;
+            }
+            if (!is_var_true(lit_values, var)) {
+                assign_var(solver, var, NO_CLAUSE);
             }
         }
-        free(positive_occurance_list);
     }
-    if (negative_occurance_list != NULL) {
-        for (size_t i = 0, vars_num = cnf->vars_num; i < vars_num; ++i) {
-            while (negative_occurance_list[i] != NULL) {
-                list_drop_current(&negative_occurance_list[i]);
+
+    return propagate_units(solver) == NO_CLAUSE;
+}
+
+static size_t choose_var(Solver* solver) {
+    assert(solver != NULL);
+
+    const TriVector* vars_states = solver->trail->vars_states;
+    size_t var = solver->vars_num;
+    switch (solver->options->branching) {
+        case BRANCHING_ORDERED:
+            var = trivector_index_of_not_set(vars_states);
+            break;
+        case BRANCHING_VSIDS:
+        default:
+            // Assigned vars are removed from heap lazily
+            while (!var_heap_is_empty(solver->heap)) {
+                size_t candidate = var_heap_pop_max(solver->heap);
+                if (trivector_is_not_set(vars_states, candidate)) {
+                    var = candidate;
+                    break;
+                }
             }
+            break;
+    }
+
+    assert(var >= solver->vars_num || trivector_is_not_set(vars_states, var));
+    return var;
+}
+
+static inline signed int choose_polarity(const Solver* solver, size_t var) {
+    assert(solver != NULL);
+
+    return solver->saved_phases[var] ? (signed int) (var + 1) : -(signed int) (var + 1);
+}
+
+static void var_branching(
+    Solver* solver,
+    size_t toggled_var
+) {
+    assert(solver != NULL);
+    assert(trivector_is_not_set(solver->trail->vars_states, toggled_var));
+
+    ++solver->stats.decisions;
+    solver->flipped[solver->trail->levels_num] = false;
+    new_level(solver);
+    assign_var(solver, choose_polarity(solver, toggled_var), NO_CLAUSE);
+}
+
+/**
+ * DPLL proof: adds the clause of negated decisions of the first levels_num levels, which is implied
+ * by unit propagation, once the clauses of all deeper levels are in the proof.
+ */
+static void add_decisions_lemma(Solver* solver, size_t levels_num) {
+    assert(solver != NULL);
+    assert(levels_num <= solver->trail->levels_num);
+
+    const Trail* trail = solver->trail;
+    for (size_t level = 0; level < levels_num; ++level) {
+        solver->learnt[level] = -trail->vars[trail->level_starts[level]];
+    }
+    proof_add(solver->options->proof, solver->learnt, levels_num);
+}
+
+/**
+ * Undoes levels, which decisions were already flipped, and flips the decision of the deepest remaining level.
+ * Returns false if there is no level left to flip.
+ */
+static bool backtrack(Solver* solver) {
+    assert(solver != NULL);
+
+    Trail* trail = solver->trail;
+    bool* flipped = solver->flipped;
+    size_t levels_num = trail->levels_num;
+    size_t level = levels_num;
+    while (level > 0 && flipped[level - 1]) {
+        --level;
+    }
+    if (solver->options->proof != NULL) {
+        // Decision of each undone level is implied by the clause of the shallower ones, so clauses are added
+        // from the deepest level up to the one to flip (the empty clause is added, once search is over)
+        size_t lemma_len = level == levels_num ? levels_num : levels_num - 1;
+        for (; lemma_len >= level && lemma_len > 0; --lemma_len) {
+            add_decisions_lemma(solver, lemma_len);
         }
-        free(negative_occurance_list);
     }
-    while (cur_state != NULL) {
-        free_trivector(cur_state->vars_states);
-        pop_dpll_state(&cur_state);
+    if (level == 0) {
+        return false;
     }
-    return result;
+
+    signed int decided_var = trail->vars[trail->level_starts[level - 1]];
+    ++solver->stats.backtracks;
+    backtrack_to(solver, level - 1);
+    flipped[trail->levels_num] = true;
+    new_level(solver);
+    assign_var(solver, -decided_var, NO_CLAUSE);
+    return true;
 }
 
+/**
+ * Derives the first-UIP clause from the conflict and stores it in solver->learnt.
+ * The asserting var is put first, and the var of the backjump level (if any) is put second.
+ * Returns length of the learned clause and stores the level to backjump to in backjump_level.
+ */
+static size_t analyze_conflict(
+    Solver* solver,
+    size_t conflict,
+    size_t* backjump_level
+) {
+    assert(solver != NULL);
+    assert(conflict != NO_CLAUSE);
+    assert(backjump_level != NULL);
+
+    const ClauseDb* db = solver->db;
+    Trail* trail = solver->trail;
+    bool* seen = solver->seen;
+    signed int* learnt = solver->learnt;
+    size_t current_level = trail->levels_num;
+    size_t learnt_len = 1; // learnt[0] is reserved for the asserting var
+    size_t current_level_vars = 0;
+    size_t trail_index = trail->len;
+    signed int implied_var = 0;
+    size_t reason = conflict;
+
+    do {
+        assert(reason != NO_CLAUSE);
+        bump_clause_activity(solver, reason);
+        size_t len = 0;
+        const signed int* vars = clausedb_clause_vars(db, reason, &len);
+        for (size_t var_num = 0; var_num < len; ++var_num) {
+            signed int var = vars[var_num];
+            size_t var_index = var_to_index(var);
+            if (var == implied_var || seen[var_index]) {
+                continue;
+            }
+            size_t level = trail_level_of(trail, var);
+            if (level == 0) {
+                // Vars of level 0 are false in any case
+                continue;
+            }
+            seen[var_index] = true;
+            bump_var_activity(solver, var_index);
+            if (level == current_level) {
+                ++current_level_vars;
+            } else {
+                learnt[learnt_len++] = var;
+            }
+        }
+
+        // Next var to resolve on is the latest assigned var of the current level, that was met in the clauses
+        do {
+            assert(trail_index > 0);
+            implied_var = trail->vars[--trail_index];
+        } while (!seen[var_to_index(implied_var)]);
+        seen[var_to_index(implied_var)] = false;
+        reason = solver->reasons[var_to_index(implied_var)];
+        --current_level_vars;
+    } while (current_level_vars > 0);
+    learnt[0] = -implied_var;
+
+    *backjump_level = 0;
+    size_t max_level_var_num = 1;
+    for (size_t var_num = 1; var_num < learnt_len; ++var_num) {
+        seen[var_to_index(learnt[var_num])] = false;
+        size_t level = trail_level_of(trail, learnt[var_num]);
+        if (level > *backjump_level) {
+            *backjump_level = level;
+            max_level_var_num = var_num;
+        }
+    }
+    if (learnt_len > 1) {
+        signed int tmp = learnt[1];
+        learnt[1] = learnt[max_level_var_num];
+        learnt[max_level_var_num] = tmp;
+    }
+    return learnt_len;
+}
+
+/**
+ * Computes the number of distinct decision levels among the vars (literal block distance).
+ */
+static size_t compute_lbd(Solver* solver, const signed int* vars, size_t len) {
+    assert(solver != NULL);
+    assert(vars != NULL);
+
+    size_t stamp = ++solver->level_stamp;
+    size_t* level_stamps = solver->level_stamps;
+    size_t lbd = 0;
+    for (size_t var_num = 0; var_num < len; ++var_num) {
+        size_t level = trail_level_of(solver->trail, vars[var_num]);
+        if (level_stamps[level] != stamp) {
+            level_stamps[level] = stamp;
+            ++lbd;
+        }
+    }
+    return lbd;
+}
+
+/**
+ * i-th item (starting from zero) of Luby sequence: 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8, ...
+ */
+static size_t luby(size_t i) {
+    // Find the smallest complete subsequence (of length 2^k - 1) that contains i
+    size_t len = 1;
+    size_t power = 0;
+    while (len < i + 1) {
+        ++power;
+        len = 2 * len + 1;
+    }
+    while (len - 1 != i) {
+        len = (len - 1) / 2;
+        --power;
+        i %= len;
+    }
+    return (size_t) 1 << power;
+}
+
+static void on_learned_clause(Solver* solver, size_t lbd) {
+    assert(solver != NULL);
+
+    ++solver->conflicts_since_restart;
+    solver->lbd_sum += (double) lbd;
+    solver->fast_lbd_average += GLUCOSE_FAST_EMA_ALPHA * ((double) lbd - solver->fast_lbd_average);
+}
+
+static bool should_restart(const Solver* solver) {
+    assert(solver != NULL);
+
+    switch (solver->options->restarts) {
+        case RESTARTS_LUBY:
+            return solver->conflicts_since_restart >= luby(solver->luby_index) * solver->options->luby_unit;
+        case RESTARTS_GLUCOSE: {
+            if (solver->conflicts_since_restart < GLUCOSE_RESTART_MIN_CONFLICTS) {
+                return false;
+            }
+            double global_lbd_average = solver->lbd_sum / (double) solver->stats.learned_clauses;
+            return solver->fast_lbd_average * GLUCOSE_RESTART_MARGIN > global_lbd_average;
+        }
+        case RESTARTS_NONE:
+        default:
+            return false;
+    }
+}
+
+static void restart(Solver* solver) {
+    assert(solver != NULL);
+
+    ++solver->stats.restarts;
+    ++solver->luby_index;
+    solver->conflicts_since_restart = 0;
+    backtrack_to(solver, 0);
+}
+
+/**
+ * Assigns the literal at a new level and propagates it. Returns false on conflict, otherwise
+ * the literals it implies follow it on the trail. Level is left for the caller to undo.
+ */
+static bool probe_literal(Solver* solver, signed int var) {
+    assert(solver != NULL);
+
+    trail_new_level(solver->trail);
+    assign_var(solver, var, NO_CLAUSE);
+    return propagate_units(solver) == NO_CLAUSE;
+}
+
+/**
+ * Assigns the literal found by probing at the root and propagates it. Returns false, if the CNF is unsatisfiable.
+ */
+static bool fix_root_literal(Solver* solver, signed int var) {
+    assert(solver != NULL);
+    assert(solver->trail->levels_num == 0);
+
+    const unsigned char* lit_values = solver->trail->lit_values;
+    if (is_var_true(lit_values, var)) {
+        return true;
+    }
+    if (solver->options->proof != NULL) {
+        proof_add(solver->options->proof, &var, 1);
+    }
+    if (is_var_false(lit_values, var)) {
+        return false;
+    }
+    ++solver->stats.probed_units;
+    assign_var(solver, var, NO_CLAUSE);
+    return propagate_units(solver) == NO_CLAUSE;
+}
+
+/**
+ * Failed-literal probing at the root: assigns each value of a var in turn and propagates it. If a value leads
+ * to a conflict, the other one is fixed, otherwise literals implied by both values are fixed. Vars are visited
+ * round-robin, continuing from the previous round, until the propagation budget of the round is spent.
+ * Returns false, if the CNF is unsatisfiable.
+ */
+static bool probe_literals(Solver* solver) {
+    assert(solver != NULL);
+    assert(solver->trail->levels_num == 0);
+    assert(solver->trail->propagated == solver->trail->len);
+
+    Trail* trail = solver->trail;
+    const WatchList* lists = solver->watches->lists;
+    Proof* proof = solver->options->proof;
+    signed int* implied = solver->learnt; // Conflict analysis does not run during probing
+    size_t vars_num = solver->vars_num;
+    size_t units_num = solver->stats.probed_units;
+    size_t budget = (size_t) ((double) (solver->stats.propagations - solver->probe_propagations) * PROBE_BUDGET_RATIO);
+    size_t budget_end = solver->stats.propagations + (budget > PROBE_MIN_BUDGET ? budget : PROBE_MIN_BUDGET);
+    for (size_t visited = 0; visited < vars_num && solver->stats.propagations < budget_end; ++visited) {
+        size_t var_index = solver->probe_cursor;
+        solver->probe_cursor = var_index + 1 < vars_num ? var_index + 1 : 0;
+        if (!trivector_is_not_set(trail->vars_states, var_index)
+            || lit_occurances(&lists[2 * var_index]) + lit_occurances(&lists[2 * var_index + 1]) == 0) {
+            continue;
+        }
+
+        signed int var = (signed int) var_index + 1;
+        size_t start = trail->len;
+        bool is_consistent = probe_literal(solver, var);
+        size_t implied_num = 0;
+        for (size_t i = start + 1; is_consistent && i < trail->len; ++i) {
+            implied[implied_num++] = trail->vars[i];
+        }
+        unassign_levels(solver, 0, false);
+        if (!is_consistent) {
+            if (!fix_root_literal(solver, -var)) {
+                return false;
+            }
+            continue;
+        }
+
+        is_consistent = probe_literal(solver, -var);
+        // Literals implied by the positive value, that are true now, are implied by the negative one as well
+        size_t both_num = 0;
+        for (size_t i = 0; is_consistent && i < implied_num; ++i) {
+            if (is_var_true(trail->lit_values, implied[i])) {
+                implied[both_num++] = implied[i];
+            }
+        }
+        unassign_levels(solver, 0, false);
+        if (!is_consistent) {
+            if (!fix_root_literal(solver, var)) {
+                return false;
+            }
+            continue;
+        }
+
+        for (size_t i = 0; i < both_num; ++i) {
+            // Unit is implied by the two binary clauses, which are implied by propagation of each value
+            signed int positive_implies[2] = {-var, implied[i]};
+            signed int negative_implies[2] = {var, implied[i]};
+            if (proof != NULL) {
+                proof_add(proof, positive_implies, 2);
+                proof_add(proof, negative_implies, 2);
+            }
+            bool is_fixed = fix_root_literal(solver, implied[i]);
+            if (proof != NULL) {
+                proof_delete(proof, positive_implies, 2);
+                proof_delete(proof, negative_implies, 2);
+            }
+            if (!is_fixed) {
+                return false;
+            }
+        }
+    }
+    solver->probe_propagations = solver->stats.propagations;
+    if (solver->stats.probed_units == units_num) {
+        solver->probe_interval *= 2;
+    }
+    solver->next_probe = solver->stats.conflicts + solver->probe_interval;
+    return true;
+}
+
+/**
+ * Checks, whether a probing round is due. It runs at the root only, where its units are fixed for good.
+ */
+static inline bool should_probe(const Solver* solver) {
+    assert(solver != NULL);
+
+    return solver->options->probing && solver->trail->levels_num == 0 && solver->stats.conflicts >= solver->next_probe;
+}
+
+static int compare_reduce_candidates(const void* lhs, const void* rhs) {
+    const ReduceCandidate* left = (const ReduceCandidate*) lhs;
+    const ReduceCandidate* right = (const ReduceCandidate*) rhs;
+    // Least useful first: higher LBD, then lower activity
+    if (left->lbd != right->lbd) {
+        return left->lbd > right->lbd ? -1 : 1;
+    }
+    if (left->activity != right->activity) {
+        return left->activity < right->activity ? -1 : 1;
+    }
+    return 0;
+}
+
+/**
+ * Makes room for the given number of learned clauses in the scratch of reduce_learnts.
+ * It is sized by capacity of the learned clauses storage, so it grows as rarely as the storage does.
+ */
+static int reserve_reduce_scratch(Solver* solver, size_t capacity) {
+    assert(solver != NULL);
+
+    if (capacity <= solver->reduce_capacity) {
+        return 0;
+    }
+    bool* locked = (bool*) realloc(solver->reduce_locked, capacity * sizeof(bool));
+    if (locked != NULL) {
+        solver->reduce_locked = locked;
+    }
+    ReduceCandidate* candidates = (ReduceCandidate*) realloc(solver->reduce_candidates, capacity * sizeof(ReduceCandidate));
+    if (candidates != NULL) {
+        solver->reduce_candidates = candidates;
+    }
+    size_t* relocations = (size_t*) realloc(solver->reduce_relocations, capacity * sizeof(size_t));
+    if (relocations != NULL) {
+        solver->reduce_relocations = relocations;
+    }
+    if (locked == NULL || candidates == NULL || relocations == NULL) {
+        DPLL_ERROR("Insufficient memory");
+        return -1;
+    }
+    solver->reduce_capacity = capacity;
+    return 0;
+}
+
+/**
+ * Deletes the least useful half of learned clauses (except glue ones and reasons of current assignments)
+ * and compacts the clause storage. Watches and reasons are renumbered accordingly.
+ */
+static int reduce_learnts(Solver* solver) {
+    assert(solver != NULL);
+
+    ClauseDb* db = solver->db;
+    Trail* trail = solver->trail;
+    Watches* watches = solver->watches;
+    size_t first_learnt_num = db->cnf->clauses_num;
+    size_t learnts_num = db->learnts_num;
+    if (reserve_reduce_scratch(solver, db->learnts_capacity + 1) != 0) {
+        return -1;
+    }
+    bool* locked = solver->reduce_locked;
+    ReduceCandidate* candidates = solver->reduce_candidates;
+    size_t* relocations = solver->reduce_relocations;
+    memset(locked, 0, learnts_num * sizeof(bool));
+
+    for (size_t i = 0; i < trail->len; ++i) {
+        size_t reason = solver->reasons[var_to_index(trail->vars[i])];
+        if (reason != NO_CLAUSE && clausedb_is_learnt(db, reason)) {
+            locked[reason - first_learnt_num] = true;
+        }
+    }
+
+    size_t candidates_num = 0;
+    for (size_t i = 0; i < learnts_num; ++i) {
+        LearntClause* clause = &db->learnts[i];
+        // Binary clauses are glue ones anyway, so binary clause lists never lose clauses
+        if (!locked[i] && !clause->irredundant && clause->lbd > REDUCE_DB_GLUE_LBD && clause->len > 2) {
+            candidates[candidates_num].learnt_index = i;
+            candidates[candidates_num].lbd = clause->lbd;
+            candidates[candidates_num].activity = clause->activity;
+            ++candidates_num;
+        }
+    }
+    qsort(candidates, candidates_num, sizeof(ReduceCandidate), compare_reduce_candidates);
+
+    size_t to_delete = learnts_num / 2 < candidates_num ? learnts_num / 2 : candidates_num;
+    for (size_t i = 0; i < to_delete; ++i) {
+        size_t learnt_index = candidates[i].learnt_index;
+        LearntClause* clause = &db->learnts[learnt_index];
+        clause->deleted = true;
+        if (solver->options->proof != NULL) {
+            proof_delete(solver->options->proof, db->vars + clause->offset, clause->len);
+        }
+        for (size_t var_num = 0; var_num < clause->len; ++var_num) {
+            --watches->lists[lit_to_index(db->vars[clause->offset + var_num])].occurances;
+        }
+    }
+
+    clausedb_compact(db, relocations);
+
+    for (size_t i = 0; i < learnts_num; ++i) {
+        size_t new_num = relocations[i];
+        if (new_num != NO_CLAUSE) {
+            // Clauses only move to the front, so positions of not yet moved clauses are never overwritten
+            size_t old_num = first_learnt_num + i;
+            watches->positions[2 * new_num] = watches->positions[2 * old_num];
+            watches->positions[2 * new_num + 1] = watches->positions[2 * old_num + 1];
+        }
+    }
+    for (size_t lit_index = 0; lit_index < watches->lits_num; ++lit_index) {
+        WatchList* list = &watches->lists[lit_index];
+        size_t kept = 0;
+        for (size_t i = 0, len = list->len; i < len; ++i) {
+            size_t clause_num = list->clauses[i];
+            if (clause_num >= first_learnt_num) {
+                clause_num = relocations[clause_num - first_learnt_num];
+                if (clause_num == NO_CLAUSE) {
+                    continue;
+                }
+            }
+            list->clauses[kept++] = clause_num;
+        }
+        list->len = kept;
+        for (size_t i = 0, len = list->binaries_len; i < len; ++i) {
+            size_t clause_num = list->binaries[i].clause_num;
+            if (clause_num >= first_learnt_num) {
+                list->binaries[i].clause_num = relocations[clause_num - first_learnt_num];
+                assert(list->binaries[i].clause_num != NO_CLAUSE);
+            }
+        }
+    }
+    for (size_t i = 0; i < trail->len; ++i) {
+        size_t* reason = &solver->reasons[var_to_index(trail->vars[i])];
+        if (*reason != NO_CLAUSE && clausedb_is_learnt(db, *reason)) {
+            *reason = relocations[*reason - first_learnt_num];
+            assert(*reason != NO_CLAUSE);
+        }
+    }
+
+    ++solver->stats.reductions;
+    solver->stats.deleted_clauses += to_delete;
+    return 0;
+}
+
+/**
+ * Stores the false assumption and the assumptions, that imply its negation, as failed ones.
+ * Every level is an assumption level here, so vars without reason above level 0 are assumptions.
+ */
+static void analyze_final(Solver* solver, signed int false_assumption) {
+    assert(solver != NULL);
+    assert(is_var_false(solver->trail->lit_values, false_assumption));
+
+    const ClauseDb* db = solver->db;
+    Trail* trail = solver->trail;
+    bool* seen = solver->seen;
+    solver->failed[solver->failed_num++] = false_assumption;
+    if (trail->levels_num == 0 || trail_level_of(trail, false_assumption) == 0) {
+        return;
+    }
+
+    seen[var_to_index(false_assumption)] = true;
+    for (size_t i = trail->len; i > trail->level_starts[0]; --i) {
+        signed int var = trail->vars[i - 1];
+        size_t var_index = var_to_index(var);
+        if (!seen[var_index]) {
+            continue;
+        }
+        seen[var_index] = false;
+        size_t reason = solver->reasons[var_index];
+        if (reason == NO_CLAUSE) {
+            solver->failed[solver->failed_num++] = var;
+            continue;
+        }
+        size_t len = 0;
+        const signed int* vars = clausedb_clause_vars(db, reason, &len);
+        for (size_t var_num = 0; var_num < len; ++var_num) {
+            if (vars[var_num] != var && trail_level_of(trail, vars[var_num]) > 0) {
+                seen[var_to_index(vars[var_num])] = true;
+            }
+        }
+    }
+}
+
+/**
+ * Decides the assumption of the next level, already true assumption gets a level without vars.
+ * Returns false, if the assumption is already false (see analyze_final).
+ */
+static bool decide_assumption(Solver* solver) {
+    assert(solver != NULL);
+    assert(solver->trail->levels_num < solver->assumptions_num);
+
+    Trail* trail = solver->trail;
+    signed int assumption = solver->assumptions[trail->levels_num];
+    if (is_var_false(trail->lit_values, assumption)) {
+        analyze_final(solver, assumption);
+        return false;
+    }
+    // DPLL never flips assumptions
+    solver->flipped[trail->levels_num] = true;
+    new_level(solver);
+    if (!is_var_true(trail->lit_values, assumption)) {
+        assign_var(solver, assumption, NO_CLAUSE);
+    }
+    return true;
+}
+
+static DpllResult search_dpll(Solver* solver) {
+    assert(solver != NULL);
+
+    const ClauseDb* db = solver->db;
+    const SatCounters* counters = solver->counters;
+    assert(counters != NULL && counters->clauses_num == clausedb_clauses_num(db));
+    while (true) {
+        size_t conflict = propagate_units(solver);
+        bool has_conflict = conflict != NO_CLAUSE;
+        if (has_conflict) {
+            ++solver->stats.conflicts;
+            size_t len = 0;
+            const signed int* vars = clausedb_clause_vars(solver->db, conflict, &len);
+            for (size_t var_num = 0; var_num < len; ++var_num) {
+                bump_var_activity(solver, var_to_index(vars[var_num]));
+            }
+            decay_var_activities(solver);
+        }
+
+        // Watches find every clause with all vars false during propagation
+        assert(has_conflict || !has_contradictions(db, solver->trail->lit_values));
+
+        bool has_assumptions_left = solver->trail->levels_num < solver->assumptions_num;
+        if (!has_conflict && !has_assumptions_left && counters->sat_clauses_num == clausedb_clauses_num(db)) {
+            assert(is_definitely_sat(db, solver->trail->lit_values));
+            return SAT;
+        }
+
+        if (has_conflict) {
+            if (!backtrack(solver)) {
+                return UNSAT;
+            }
+            continue;
+        }
+
+        if (should_probe(solver)) {
+            if (!probe_literals(solver)) {
+                return UNSAT;
+            }
+            continue;
+        }
+
+        if (should_stop(solver)) {
+            return UNKNOWN;
+        }
+
+        if (has_assumptions_left) {
+            if (!decide_assumption(solver)) {
+                return UNSAT;
+            }
+            continue;
+        }
+
+        size_t toggled_var = choose_var(solver);
+        if (toggled_var >= solver->vars_num) {
+            return SAT;
+        }
+
+        var_branching(solver, toggled_var);
+    }
+}
+
+static DpllResult search_cdcl(Solver* solver) {
+    assert(solver != NULL);
+
+    Trail* trail = solver->trail;
+    while (true) {
+        if (should_stop(solver)) {
+            return UNKNOWN;
+        }
+
+        size_t conflict = propagate_units(solver);
+        if (conflict != NO_CLAUSE) {
+            ++solver->stats.conflicts;
+            if (trail->levels_num == 0) {
+                solver->is_unsat = true;
+                return UNSAT;
+            }
+
+            size_t backjump_level = 0;
+            size_t learnt_len = analyze_conflict(solver, conflict, &backjump_level);
+            decay_var_activities(solver);
+            decay_clause_activities(solver);
+            ++solver->stats.learned_clauses;
+            if (solver->options->proof != NULL) {
+                proof_add(solver->options->proof, solver->learnt, learnt_len);
+            }
+            size_t lbd = compute_lbd(solver, solver->learnt, learnt_len);
+            on_learned_clause(solver, lbd);
+            ++solver->stats.backtracks;
+            backtrack_to(solver, backjump_level);
+            if (learnt_len == 1) {
+                assign_var(solver, solver->learnt[0], NO_CLAUSE);
+                continue;
+            }
+
+            size_t clause_num = clausedb_add_learnt(solver->db, solver->learnt, learnt_len, lbd);
+            if (clause_num == NO_CLAUSE || watch_new_clause(solver->watches, clause_num, solver->learnt, learnt_len) != 0) {
+                DPLL_ERROR("Insufficient memory");
+                return ERROR;
+            }
+            assign_var(solver, solver->learnt[0], clause_num);
+            continue;
+        }
+
+        if (should_restart(solver)) {
+            restart(solver);
+        }
+
+        if (solver->stats.conflicts >= solver->next_reduce) {
+            solver->next_reduce = solver->stats.conflicts + REDUCE_DB_FIRST + REDUCE_DB_INC * (solver->stats.reductions + 1);
+            if (reduce_learnts(solver) != 0) {
+                return ERROR;
+            }
+        }
+
+        if (should_probe(solver)) {
+            if (!probe_literals(solver)) {
+                solver->is_unsat = true;
+                return UNSAT;
+            }
+            continue;
+        }
+
+        if (trail->levels_num < solver->assumptions_num) {
+            if (!decide_assumption(solver)) {
+                return UNSAT;
+            }
+            continue;
+        }
+
+        size_t toggled_var = choose_var(solver);
+        if (toggled_var >= solver->vars_num) {
+            return SAT;
+        }
+
+        ++solver->stats.decisions;
+        new_level(solver);
+        assign_var(solver, choose_polarity(solver, toggled_var), NO_CLAUSE);
+    }
+}
+
+void dpll_free_solver(Solver* solver) {
+    if (solver != NULL) {
+        free_clausedb(solver->db);
+        free_watches(solver->watches);
+        free_sat_counters(solver->counters);
+        free_trail(solver->trail);
+        free(solver->reasons);
+        free(solver->flipped);
+        free(solver->seen);
+        free(solver->learnt);
+        free(solver->activities);
+        free_var_heap(solver->heap);
+        free(solver->saved_phases);
+        free(solver->level_stamps);
+        free(solver->failed);
+        free(solver->reduce_locked);
+        free(solver->reduce_candidates);
+        free(solver->reduce_relocations);
+        free(solver->lookahead_candidates);
+        free(solver);
+    }
+}
+
+Solver* dpll_create_solver(const CNF* cnf, const DpllOptions* options) {
+    assert(cnf != NULL);
+    assert(options != NULL);
+
+    size_t vars_num = cnf->vars_num;
+    Solver* solver = (Solver*) calloc(1, sizeof(Solver));
+    if (solver == NULL) {
+        DPLL_ERROR("Insufficient memory");
+        return NULL;
+    }
+    solver->cnf = cnf;
+    solver->options = options;
+    solver->vars_num = vars_num;
+    solver->next_progress = options->progress_interval;
+
+    solver->db = create_clausedb(cnf);
+    solver->watches = create_watches(cnf);
+    if (options->mode == SEARCH_DPLL) {
+        solver->counters = create_sat_counters(2 * vars_num);
+    }
+    solver->trail = create_trail(vars_num);
+    solver->reasons = (size_t*) calloc(vars_num + 1, sizeof(size_t));
+    solver->flipped = (bool*) calloc(vars_num + 1, sizeof(bool));
+    solver->seen = (bool*) calloc(vars_num + 1, sizeof(bool));
+    solver->learnt = (signed int*) calloc(vars_num + 1, sizeof(signed int));
+    solver->activities = (double*) calloc(vars_num + 1, sizeof(double));
+    solver->activity_inc = 1.0;
+    solver->clause_activity_inc = 1.0;
+    solver->next_reduce = REDUCE_DB_FIRST;
+    solver->probe_interval = PROBE_INTERVAL;
+    solver->saved_phases = (bool*) calloc(vars_num + 1, sizeof(bool));
+    solver->level_stamps = (size_t*) calloc(vars_num + 1, sizeof(size_t));
+    if (solver->db == NULL || solver->watches == NULL || (options->mode == SEARCH_DPLL && solver->counters == NULL) || solver->trail == NULL || solver->reasons == NULL
+        || solver->flipped == NULL || solver->seen == NULL || solver->learnt == NULL || solver->activities == NULL
+        || solver->saved_phases == NULL || solver->level_stamps == NULL) {
+        DPLL_ERROR("Insufficient memory");
+        dpll_free_solver(solver);
+        return NULL;
+    }
+
+    // Zero seed keeps xorshift at zero, so it is replaced by an arbitrary non-zero constant
+    solver->random_state = options->seed != 0 ? options->seed : 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < vars_num; ++i) {
+        if (options->seed != 0) {
+            // Tiny initial activities only break ties, so they are forgotten after the first bumps
+            solver->activities[i] = (double) (next_random(solver) >> 11) * 0x1.0p-53 * 1e-6;
+        }
+        switch (options->initial_phase) {
+            case PHASE_TRUE:
+                solver->saved_phases[i] = true;
+                break;
+            case PHASE_FALSE:
+                solver->saved_phases[i] = false;
+                break;
+            case PHASE_RANDOM:
+                solver->saved_phases[i] = (next_random(solver) >> 63) != 0;
+                break;
+        }
+    }
+    solver->heap = create_var_heap(vars_num, solver->activities);
+    if (solver->heap == NULL) {
+        DPLL_ERROR("Insufficient memory");
+        dpll_free_solver(solver);
+        return NULL;
+    }
+    solver->is_unsat = !propagate_all_units(solver);
+    if (solver->is_unsat && options->proof != NULL) {
+        proof_add(options->proof, NULL, 0);
+    }
+    return solver;
+}
+
+DpllOptions dpll_default_options(void) {
+    DpllOptions options = {
+        .mode = SEARCH_CDCL,
+        .branching = BRANCHING_VSIDS,
+        .restarts = RESTARTS_GLUCOSE,
+        .luby_unit = 100,
+        .phase_saving = true,
+        .initial_phase = PHASE_TRUE,
+        .seed = 0,
+        .cancelled = NULL,
+        .terminate = NULL,
+        .terminate_data = NULL,
+        .time_limit = 0.0,
+        .conflicts_limit = 0,
+        .decisions_limit = 0,
+        .memory_limit = 0,
+        .progress = NULL,
+        .progress_data = NULL,
+        .progress_interval = 0.0,
+        .probing = true,
+        .local_search_flips = 0,
+        .proof = NULL,
+    };
+    return options;
+}
+
+/**
+ * Reallocates array of per-var (or per-level) items to hold vars_num + 1 of them, zeroing the new ones.
+ * Array is passed by address of any pointer type, which is read and written with memcpy.
+ */
+static int grow_array(void* array_address, size_t item_size, size_t old_vars_num, size_t vars_num) {
+    void* array = NULL;
+    memcpy(&array, array_address, sizeof(void*));
+    char* grown = (char*) realloc(array, (vars_num + 1) * item_size);
+    if (grown == NULL) {
+        return -1;
+    }
+    memset(grown + (old_vars_num + 1) * item_size, 0, (vars_num - old_vars_num) * item_size);
+    memcpy(array_address, &grown, sizeof(void*));
+    return 0;
+}
+
+/**
+ * Makes room for levels up to levels_num in the trail and per-level arrays.
+ */
+static int reserve_levels(Solver* solver, size_t levels_num) {
+    assert(solver != NULL);
+
+    size_t capacity = solver->trail->levels_capacity;
+    if (levels_num <= capacity) {
+        return 0;
+    }
+    if (grow_array(&solver->flipped, sizeof(bool), capacity, levels_num) != 0
+        || grow_array(&solver->level_stamps, sizeof(size_t), capacity, levels_num) != 0
+        || trail_reserve_levels(solver->trail, levels_num) != 0) {
+        DPLL_ERROR("Insufficient memory");
+        return -1;
+    }
+    return 0;
+}
+
+int dpll_add_vars(Solver* solver, size_t vars_num) {
+    assert(solver != NULL);
+
+    size_t old_vars_num = solver->vars_num;
+    if (vars_num <= old_vars_num) {
+        return 0;
+    }
+    if (reserve_levels(solver, vars_num) != 0) {
+        return -1;
+    }
+    Watches* watches = solver->watches;
+    WatchList* lists = (WatchList*) realloc(watches->lists, 2 * vars_num * sizeof(WatchList));
+    if (lists != NULL) {
+        memset(lists + watches->lits_num, 0, (2 * vars_num - watches->lits_num) * sizeof(WatchList));
+        watches->lists = lists;
+        watches->lits_num = 2 * vars_num;
+    }
+    SatCounters* counters = solver->counters;
+    size_t* occurance_starts = NULL;
+    if (counters != NULL) {
+        occurance_starts = (size_t*) realloc(counters->occurance_starts, (2 * vars_num + 1) * sizeof(size_t));
+        if (occurance_starts != NULL) {
+            // New literals occur in no indexed clauses
+            for (size_t i = counters->lits_num + 1; i < 2 * vars_num + 1; ++i) {
+                occurance_starts[i] = occurance_starts[counters->lits_num];
+            }
+            counters->occurance_starts = occurance_starts;
+            counters->lits_num = 2 * vars_num;
+        }
+    }
+    if (lists == NULL
+        || (counters != NULL && occurance_starts == NULL)
+        || grow_array(&solver->reasons, sizeof(size_t), old_vars_num, vars_num) != 0
+        || grow_array(&solver->seen, sizeof(bool), old_vars_num, vars_num) != 0
+        || grow_array(&solver->learnt, sizeof(signed int), old_vars_num, vars_num) != 0
+        || grow_array(&solver->activities, sizeof(double), old_vars_num, vars_num) != 0
+        || grow_array(&solver->saved_phases, sizeof(bool), old_vars_num, vars_num) != 0
+        || trail_grow(solver->trail, vars_num) != 0
+        || var_heap_grow(solver->heap, vars_num, solver->activities) != 0) {
+        DPLL_ERROR("Insufficient memory");
+        return -1;
+    }
+    solver->vars_num = vars_num;
+
+    for (size_t i = old_vars_num; i < vars_num; ++i) {
+        switch (solver->options->initial_phase) {
+            case PHASE_TRUE:
+                solver->saved_phases[i] = true;
+                break;
+            case PHASE_FALSE:
+                solver->saved_phases[i] = false;
+                break;
+            case PHASE_RANDOM:
+                solver->saved_phases[i] = (next_random(solver) >> 63) != 0;
+                break;
+        }
+        var_heap_insert(solver->heap, i);
+    }
+    return 0;
+}
+
+int dpll_add_clause(Solver* solver, const signed int* vars, size_t len) {
+    assert(solver != NULL);
+    assert(vars != NULL || len == 0);
+
+    if (solver->is_unsat) {
+        return 0;
+    }
+    backtrack_to(solver, 0);
+    const unsigned char* lit_values = solver->trail->lit_values;
+    bool* seen = solver->seen;
+    signed int* kept = solver->learnt;
+    size_t kept_len = 0;
+    bool is_satisfied = false;
+    // Vars of level 0 never change, so true ones satisfy the clause forever and false ones are dropped
+    for (size_t var_num = 0; var_num < len && !is_satisfied; ++var_num) {
+        signed int var = vars[var_num];
+        assertf(var != 0 && var_to_index(var) < solver->vars_num, "Expected var in [1; %zu], but got %d", solver->vars_num, var);
+        if (is_var_true(lit_values, var)) {
+            is_satisfied = true;
+        } else if (is_var_false(lit_values, var)) {
+            continue;
+        } else if (seen[var_to_index(var)]) {
+            for (size_t i = 0; i < kept_len; ++i) {
+                // Tautologies are satisfied by any assignment
+                is_satisfied = is_satisfied || kept[i] == -var;
+            }
+        } else {
+            seen[var_to_index(var)] = true;
+            kept[kept_len++] = var;
+        }
+    }
+    for (size_t i = 0; i < kept_len; ++i) {
+        seen[var_to_index(kept[i])] = false;
+    }
+
+    if (is_satisfied) {
+        return 0;
+    }
+    if (kept_len == 0) {
+        solver->is_unsat = true;
+        return 0;
+    }
+    if (kept_len == 1) {
+        assign_var(solver, kept[0], NO_CLAUSE);
+        solver->is_unsat = propagate_units(solver) != NO_CLAUSE;
+        return 0;
+    }
+    size_t clause_num = clausedb_add_learnt(solver->db, kept, kept_len, kept_len);
+    if (clause_num == NO_CLAUSE || watch_new_clause(solver->watches, clause_num, kept, kept_len) != 0) {
+        DPLL_ERROR("Insufficient memory");
+        return -1;
+    }
+    clausedb_learnt(solver->db, clause_num)->irredundant = true;
+    return 0;
+}
+
+void dpll_fix_unused_vars(Solver* solver) {
+    assert(solver != NULL);
+
+    if (solver->is_unsat) {
+        return;
+    }
+    backtrack_to(solver, 0);
+    const ClauseDb* db = solver->db;
+    bool* seen = solver->seen;
+    for (size_t clause_num = 0, clauses_num = clausedb_clauses_num(db); clause_num < clauses_num; ++clause_num) {
+        size_t len = 0;
+        const signed int* vars = clausedb_clause_vars(db, clause_num, &len);
+        for (size_t var_num = 0; var_num < len; ++var_num) {
+            seen[var_to_index(vars[var_num])] = true;
+        }
+    }
+    for (size_t var = 0; var < solver->vars_num; ++var) {
+        if (!seen[var] && trivector_is_not_set(solver->trail->vars_states, var)) {
+            // Any value satisfies the same clauses, so the one search would decide is taken
+            assign_var(solver, choose_polarity(solver, var), NO_CLAUSE);
+        }
+        seen[var] = false;
+    }
+}
+
+DpllResult dpll_solve(Solver* solver, const signed int* assumptions, size_t assumptions_num) {
+    assert(solver != NULL);
+    assert(assumptions != NULL || assumptions_num == 0);
+
+    solver->failed_num = 0;
+    if (solver->is_unsat) {
+        return UNSAT;
+    }
+    // Each assumption may get a level without vars, if it is already true
+    if (reserve_levels(solver, solver->vars_num + assumptions_num) != 0) {
+        return ERROR;
+    }
+    if (assumptions_num > solver->failed_capacity) {
+        signed int* failed = (signed int*) realloc(solver->failed, assumptions_num * sizeof(signed int));
+        if (failed == NULL) {
+            DPLL_ERROR("Insufficient memory");
+            return ERROR;
+        }
+        solver->failed = failed;
+        solver->failed_capacity = assumptions_num;
+    }
+    // Assignment of the previous call is kept until now for its model
+    backtrack_to(solver, 0);
+    SatCounters* counters = solver->counters;
+    if (counters != NULL && counters->clauses_num < clausedb_clauses_num(solver->db)
+        && index_sat_counters(counters, solver->db, solver->trail->lit_values) != 0) {
+        return ERROR;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &solver->solve_start);
+    solver->start_conflicts = solver->stats.conflicts;
+    solver->start_decisions = solver->stats.decisions;
+    solver->budget_countdown = 1; // Budgets may be already exhausted, e.g. by time spent before the call
+    solver->assumptions = assumptions;
+    solver->assumptions_num = assumptions_num;
+
+    DpllResult result = ERROR;
+    switch (solver->options->mode) {
+        case SEARCH_CDCL:
+            result = search_cdcl(solver);
+            break;
+        case SEARCH_DPLL:
+            result = search_dpll(solver);
+            break;
+        default:
+            DPLL_ERROR_F("Unknown search mode: %d", solver->options->mode);
+            result = ERROR;
+            break;
+    }
+    if (result == UNSAT && assumptions_num == 0) {
+        if (solver->options->proof != NULL) {
+            proof_add(solver->options->proof, NULL, 0);
+        }
+        solver->is_unsat = true;
+    }
+    if (result == UNSAT && !solver->is_unsat && solver->failed_num == 0) {
+        // DPLL refuted the assumptions by exhausting its decisions, so none of them can be excluded
+        memcpy(solver->failed, assumptions, assumptions_num * sizeof(signed int));
+        solver->failed_num = assumptions_num;
+    }
+    solver->assumptions = NULL;
+    solver->assumptions_num = 0;
+    solver->stats.search_time += solve_seconds(solver);
+    update_peak_memory(solver);
+    assertf(result != SAT || is_definitely_sat(solver->db, solver->trail->lit_values), "Found assignment does not satisfy CNF (mode %d)", solver->options->mode);
+    return result;
+}
+
+/**
+ * Assigns the var at a new level and returns number of vars it implies by unit propagation,
+ * or SIZE_MAX if propagation leads to a conflict. The level is undone afterwards without saving phases,
+ * so probes of lookahead never override phases saved by search.
+ */
+static size_t probe_var(Solver* solver, signed int var) {
+    assert(solver != NULL);
+
+    Trail* trail = solver->trail;
+    size_t level = trail->levels_num;
+    size_t trail_len = trail->len;
+    trail_new_level(trail);
+    assign_var(solver, var, NO_CLAUSE);
+    bool has_conflict = propagate_units(solver) != NO_CLAUSE;
+    size_t implied_num = trail->len - trail_len - 1;
+    unassign_levels(solver, level, false);
+    return has_conflict ? SIZE_MAX : implied_num;
+}
+
+DpllResult dpll_lookahead(Solver* solver, const signed int* cube, size_t cube_len, size_t candidates_num, signed int* branch_var) {
+    assert(solver != NULL);
+    assert(cube != NULL || cube_len == 0);
+    assert(branch_var != NULL);
+
+    if (solver->is_unsat) {
+        return UNSAT;
+    }
+    // Level of the cube and level of the probed var
+    if (reserve_levels(solver, 2) != 0) {
+        return ERROR;
+    }
+    backtrack_to(solver, 0);
+    Trail* trail = solver->trail;
+    trail_new_level(trail);
+    for (size_t i = 0; i < cube_len; ++i) {
+        if (is_var_false(trail->lit_values, cube[i])) {
+            unassign_levels(solver, 0, false);
+            return UNSAT;
+        }
+        if (!is_var_true(trail->lit_values, cube[i])) {
+            assign_var(solver, cube[i], NO_CLAUSE);
+        }
+    }
+    if (propagate_units(solver) != NO_CLAUSE) {
+        unassign_levels(solver, 0, false);
+        return UNSAT;
+    }
+    if (trail->len == solver->vars_num) {
+        unassign_levels(solver, 0, false);
+        return SAT;
+    }
+
+    // Candidates are unassigned vars with the most occurances, sorted by them in descending order
+    const WatchList* lists = solver->watches->lists;
+    if (candidates_num + 1 > solver->lookahead_capacity) {
+        size_t* grown = (size_t*) realloc(solver->lookahead_candidates, (candidates_num + 1) * sizeof(size_t));
+        if (grown == NULL) {
+            DPLL_ERROR("Insufficient memory");
+            unassign_levels(solver, 0, false);
+            return ERROR;
+        }
+        solver->lookahead_candidates = grown;
+        solver->lookahead_capacity = candidates_num + 1;
+    }
+    size_t* candidates = solver->lookahead_candidates;
+    size_t found_num = 0;
+    for (size_t var = 0; var < solver->vars_num; ++var) {
+        if (!trivector_is_not_set(trail->vars_states, var)) {
+            continue;
+        }
+        size_t occurances = lit_occurances(&lists[2 * var]) + lit_occurances(&lists[2 * var + 1]);
+        size_t pos = found_num < candidates_num ? found_num++ : candidates_num;
+        while (pos > 0 && lit_occurances(&lists[2 * candidates[pos - 1]]) + lit_occurances(&lists[2 * candidates[pos - 1] + 1]) < occurances) {
+            if (pos < candidates_num) {
+                candidates[pos] = candidates[pos - 1];
+            }
+            --pos;
+        }
+        if (pos < candidates_num) {
+            candidates[pos] = var;
+        }
+    }
+
+    // March-like score: product of numbers of implied vars, a failed literal fixes the var right away
+    double best_score = -1.0;
+    *branch_var = 0;
+    for (size_t i = 0; i < found_num; ++i) {
+        signed int var = (signed int) candidates[i] + 1;
+        size_t positive = probe_var(solver, var);
+        size_t negative = probe_var(solver, -var);
+        double score = positive == SIZE_MAX || negative == SIZE_MAX
+            ? INFINITY
+            : (double) (positive + 1) * (double) (negative + 1);
+        if (score > best_score) {
+            best_score = score;
+            *branch_var = var;
+            if (score == INFINITY) {
+                break;
+            }
+        }
+    }
+    unassign_levels(solver, 0, false);
+    return UNKNOWN;
+}
+
+void dpll_solver_model(const Solver* solver, bool* model) {
+    assert(solver != NULL);
+    assert(model != NULL);
+
+    for (size_t i = 0; i < solver->vars_num; ++i) {
+        // Vars, that are still unassigned, do not affect satisfiability
+        model[i] = is_var_true(solver->trail->lit_values, (signed int) (i + 1));
+    }
+}
+
+const DpllStats* dpll_solver_stats(const Solver* solver) {
+    assert(solver != NULL);
+
+    return &solver->stats;
+}
+
+int dpll_options_terminated(void* options) {
+    const DpllOptions* parent = (const DpllOptions*) options;
+    assert(parent != NULL);
+
+    return (parent->cancelled != NULL && atomic_load_explicit(parent->cancelled, memory_order_relaxed))
+        || (parent->terminate != NULL && parent->terminate(parent->terminate_data) != 0);
+}
+
+const signed int* dpll_solver_failed(const Solver* solver, size_t* failed_num) {
+    assert(solver != NULL);
+    assert(failed_num != NULL);
+
+    *failed_num = solver->failed_num;
+    return solver->failed;
+}
+
+bool dpll_solver_is_unsat(const Solver* solver) {
+    assert(solver != NULL);
+
+    return solver->is_unsat;
+}
+
+DpllResult dpll_check_sat(const CNF* cnf, const DpllOptions* options, DpllStats* stats, bool* model) {
+    assert(cnf != NULL);
+    assert(options != NULL);
+
+    if (options->mode == SEARCH_LOCAL) {
+        return local_search(cnf, options, options->local_search_flips, stats, model);
+    }
+    Solver* solver = dpll_create_solver(cnf, options);
+    if (solver == NULL) {
+        return ERROR;
+    }
+    if (options->local_search_flips > 0 && !solver->is_unsat) {
+        // A model found by local search is decided without conflicts, so systematic search just confirms it
+        DpllStats local_stats = {0};
+        if (local_search(cnf, options, options->local_search_flips, &local_stats, solver->saved_phases) == ERROR) {
+            dpll_free_solver(solver);
+            return ERROR;
+        }
+        solver->stats.flips = local_stats.flips;
+        solver->stats.search_time = local_stats.search_time;
+    }
+    // Vars removed by preprocessing occur in no clause, and no clauses are added later
+    dpll_fix_unused_vars(solver);
+    DpllResult result = dpll_solve(solver, NULL, 0);
+    if (result == SAT && model != NULL) {
+        dpll_solver_model(solver, model);
+    }
+    if (stats != NULL) {
+        *stats = solver->stats;
+    }
+    dpll_free_solver(solver);
+    return result;
+}
@@ -1,11 +1,155 @@
 #pragma once
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include "cnf.h"
+#include "proof.h"
 
 typedef enum {
     SAT,
     UNSAT,
     ERROR,
+    UNKNOWN, // Search was cancelled or exhausted its budget before the answer was found
 } DpllResult;
 
-DpllResult dpll_check_sat(const CNF* cnf);
+typedef enum {
+    SEARCH_CDCL, // Conflict-driven clause learning with non-chronological backjumping
+    SEARCH_DPLL, // Plain DPLL with chronological backtracking
+    SEARCH_LOCAL, // probSAT local search, which never answers UNSAT (dpll_check_sat only)
+} SearchMode;
+
+typedef enum {
+    BRANCHING_VSIDS,   // Var with the highest activity (bumped for vars involved in conflicts, decays over time)
+    BRANCHING_ORDERED, // Unassigned var with the lowest number
+} BranchingHeuristic;
+
+typedef enum {
+    RESTARTS_NONE,
+    RESTARTS_LUBY,    // After luby(i) * luby_unit conflicts
+    RESTARTS_GLUCOSE, // When recent learned clauses have worse LBD than the average
+} RestartPolicy;
+
+typedef enum {
+    PHASE_TRUE,
+    PHASE_FALSE,
+    PHASE_RANDOM,
+} InitialPhase;
+
+typedef struct DpllStats {
+    size_t decisions;
+    size_t propagations;
+    size_t conflicts;
+    size_t backtracks;      // Backjumps after conflicts (CDCL) or flips of decisions (DPLL)
+    size_t max_depth;       // Max number of decision levels
+    size_t learned_clauses;
+    size_t deleted_clauses;
+    size_t reductions;
+    size_t restarts;
+    size_t probed_units;    // Root literals fixed by failed-literal probing
+    size_t flips;           // Flips of local search
+    size_t peak_memory;     // Bytes allocated by the solver and the CNF, sampled as often as budgets are checked
+    double search_time;     // Seconds spent in dpll_solve calls
+} DpllStats;
+
+typedef struct DpllOptions {
+    SearchMode mode;
+    BranchingHeuristic branching;
+    RestartPolicy restarts;     // CDCL only
+    size_t luby_unit;
+    bool phase_saving;          // Decide the value a var had before it was unassigned (instead of the initial one)
+    InitialPhase initial_phase; // Value of a var, that was never assigned before
+    bool probing;               // Failed-literal probing at the root before search and periodically between restarts (CDCL)
+    // Flips of local search run by dpll_check_sat before systematic search, which starts from the best assignment found
+    // as initial phases (0 disables it). In SEARCH_LOCAL mode it limits local search itself (0 means no limit)
+    size_t local_search_flips;
+    unsigned int seed;          // Randomizes initial VSIDS order and random phases, 0 keeps the order by var numbers
+    const atomic_bool* cancelled; // Search stops with UNKNOWN result, once it is set (may be NULL)
+    int (*terminate)(void* data); // Polled during search, which stops with UNKNOWN result once it returns non-zero (may be NULL)
+    void* terminate_data;
+    // Budgets of each dpll_solve call, search stops with UNKNOWN result once any is exhausted (0 means no limit)
+    double time_limit;          // Seconds
+    size_t conflicts_limit;
+    size_t decisions_limit;
+    size_t memory_limit;        // Bytes allocated by the solver and the CNF
+    // Called with the current stats every progress_interval seconds of search (may be NULL)
+    void (*progress)(const DpllStats* stats, void* data);
+    void* progress_data;
+    double progress_interval;
+    // Learned clauses, their deletions and the final empty clause are written to it as DRAT lemmas (may be NULL).
+    // Only a single solver without assumptions writes a complete proof, so portfolio and cube searches do not support it
+    Proof* proof;
+} DpllOptions;
+
+typedef struct Solver DpllSolver;
+
+DpllOptions dpll_default_options(void);
+
+/**
+ * Terminate callback for searches run on behalf of another one, which options are passed as data.
+ * Returns non-zero, once that search is cancelled or terminated.
+ */
+int dpll_options_terminated(void* options);
+
+/**
+ * Creates a solver of the CNF, which (as well as the options) should outlive it.
+ * Learned clauses and heuristics state are kept between dpll_solve calls.
+ */
+DpllSolver* dpll_create_solver(const CNF* cnf, const DpllOptions* options);
+
+void dpll_free_solver(DpllSolver* solver);
+
+/**
+ * Makes vars up to vars_num available to the solver (new vars do not occur in any clause yet).
+ * Returns -1 if out of memory.
+ */
+int dpll_add_vars(DpllSolver* solver, size_t vars_num);
+
+/**
+ * Adds a clause over the available vars, which is kept for all subsequent dpll_solve calls.
+ * The solver is backtracked to level 0, so the model of the last call is lost. Returns -1 if out of memory.
+ */
+int dpll_add_clause(DpllSolver* solver, const signed int* vars, size_t len);
+
+/**
+ * Assigns every var, that occurs in no clause, at level 0 (to its saved phase), so search never branches on it.
+ * For solvers, which get no more clauses: such var stays fixed, even if a clause added later contains it.
+ */
+void dpll_fix_unused_vars(DpllSolver* solver);
+
+/**
+ * Checks satisfiability of the CNF under assumptions: literals, that are decided before any other ones.
+ * UNSAT means, that there is no model with all assumptions true (see dpll_solver_is_unsat).
+ */
+DpllResult dpll_solve(DpllSolver* solver, const signed int* assumptions, size_t assumptions_num);
+
+/**
+ * Look-ahead for cube splitting: assigns the cube literals and probes both values of up to candidates_num
+ * unassigned vars with the most occurances. Returns UNSAT, if the cube is refuted by unit propagation,
+ * SAT, if it assigns every var, and UNKNOWN otherwise, storing the var, that reduces the CNF the most
+ * on both branches, in branch_var (0, if there are no candidates). The solver is left at level 0.
+ */
+DpllResult dpll_lookahead(DpllSolver* solver, const signed int* cube, size_t cube_len, size_t candidates_num, signed int* branch_var);
+
+/**
+ * Stores value of var i in model[i - 1], if the last dpll_solve call returned SAT.
+ */
+void dpll_solver_model(const DpllSolver* solver, bool* model);
+
+const DpllStats* dpll_solver_stats(const DpllSolver* solver);
+
+/**
+ * Returns assumptions, that are enough to make the last dpll_solve call UNSAT, and stores their count in failed_num.
+ * No assumptions are failed, if the CNF is unsatisfiable regardless of them.
+ */
+const signed int* dpll_solver_failed(const DpllSolver* solver, size_t* failed_num);
+
+/**
+ * Checks, whether the CNF was found to be unsatisfiable regardless of assumptions.
+ */
+bool dpll_solver_is_unsat(const DpllSolver* solver);
 
+/**
+ * Checks satisfiability of the CNF. If stats is not NULL, search statistics are stored there.
+ * If model is not NULL and CNF is satisfiable, value of var i is stored in model[i - 1].
+ */
+DpllResult dpll_check_sat(const CNF* cnf, const DpllOptions* options, DpllStats* stats, bool* model);
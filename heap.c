@@ -0,0 +1,146 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "debug.h"
+#include "heap.h"
+
+static inline void place(VarHeap* heap, size_t position, size_t var) {
+    heap->vars[position] = var;
+    heap->positions[var] = position;
+}
+
+static void sift_up(VarHeap* heap, size_t position) {
+    assert(heap != NULL);
+    assert(position < heap->len);
+
+    size_t* vars = heap->vars;
+    const double* scores = heap->scores;
+    size_t var = vars[position];
+    double score = scores[var];
+    while (position > 0) {
+        size_t parent = (position - 1) / 2;
+        if (scores[vars[parent]] >= score) {
+            break;
+        }
+        place(heap, position, vars[parent]);
+        position = parent;
+    }
+    place(heap, position, var);
+}
+
+static void sift_down(VarHeap* heap, size_t position) {
+    assert(heap != NULL);
+    assert(position < heap->len);
+
+    size_t* vars = heap->vars;
+    const double* scores = heap->scores;
+    size_t len = heap->len;
+    size_t var = vars[position];
+    double score = scores[var];
+    while (2 * position + 1 < len) {
+        size_t child = 2 * position + 1;
+        if (child + 1 < len && scores[vars[child + 1]] > scores[vars[child]]) {
+            ++child;
+        }
+        if (scores[vars[child]] <= score) {
+            break;
+        }
+        place(heap, position, vars[child]);
+        position = child;
+    }
+    place(heap, position, var);
+}
+
+VarHeap* create_var_heap(size_t vars_num, const double* scores) {
+    assert(scores != NULL);
+
+    VarHeap* heap = (VarHeap*) calloc(1, sizeof(VarHeap));
+    if (heap == NULL) {
+        fprintf(stderr, "Var Heap Error: Insufficient memory\n");
+        return NULL;
+    }
+
+    heap->capacity = vars_num;
+    heap->scores = scores;
+    heap->vars = (size_t*) calloc(vars_num + 1, sizeof(size_t));
+    heap->positions = (size_t*) calloc(vars_num + 1, sizeof(size_t));
+    if (heap->vars == NULL || heap->positions == NULL) {
+        fprintf(stderr, "Var Heap Error: Insufficient memory\n");
+        free_var_heap(heap);
+        return NULL;
+    }
+
+    for (size_t var = 0; var < vars_num; ++var) {
+        place(heap, var, var);
+    }
+    heap->len = vars_num;
+    for (size_t position = vars_num / 2; position > 0; --position) {
+        sift_down(heap, position - 1);
+    }
+    return heap;
+}
+
+void free_var_heap(VarHeap* heap) {
+    if (heap != NULL) {
+        free(heap->vars);
+        free(heap->positions);
+        free(heap);
+    }
+}
+
+int var_heap_grow(VarHeap* heap, size_t vars_num, const double* scores) {
+    assert(heap != NULL);
+    assert(vars_num >= heap->capacity);
+    assert(scores != NULL);
+
+    heap->scores = scores;
+    size_t* vars = (size_t*) realloc(heap->vars, (vars_num + 1) * sizeof(size_t));
+    if (vars != NULL) {
+        heap->vars = vars;
+    }
+    size_t* positions = (size_t*) realloc(heap->positions, (vars_num + 1) * sizeof(size_t));
+    if (positions != NULL) {
+        heap->positions = positions;
+    }
+    if (vars == NULL || positions == NULL) {
+        fprintf(stderr, "Var Heap Error: Insufficient memory\n");
+        return -1;
+    }
+    for (size_t var = heap->capacity; var < vars_num; ++var) {
+        positions[var] = NOT_IN_HEAP;
+    }
+    heap->capacity = vars_num;
+    return 0;
+}
+
+void var_heap_insert(VarHeap* heap, size_t var) {
+    assert(heap != NULL);
+
+    if (var_heap_contains(heap, var)) {
+        return;
+    }
+    assert(heap->len < heap->capacity);
+    place(heap, heap->len++, var);
+    sift_up(heap, heap->len - 1);
+}
+
+void var_heap_increased(VarHeap* heap, size_t var) {
+    assert(heap != NULL);
+
+    if (var_heap_contains(heap, var)) {
+        sift_up(heap, heap->positions[var]);
+    }
+}
+
+size_t var_heap_pop_max(VarHeap* heap) {
+    assert(heap != NULL);
+    assert(!var_heap_is_empty(heap));
+
+    size_t max_var = heap->vars[0];
+    heap->positions[max_var] = NOT_IN_HEAP;
+    if (--heap->len > 0) {
+        place(heap, 0, heap->vars[heap->len]);
+        sift_down(heap, 0);
+    }
+    return max_var;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include "debug.h"
+
+#define NOT_IN_HEAP ((size_t) -1)
+
+/**
+ * Binary max-heap of var indices ordered by their scores.
+ * Position of each var is tracked, so that its score can be increased in O(log n).
+ */
+typedef struct VarHeap {
+    size_t len;
+    size_t capacity;
+    size_t* vars;        // Heap items
+    size_t* positions;   // Position of each var in vars (NOT_IN_HEAP if var is not in heap)
+    const double* scores;
+} VarHeap;
+
+/**
+ * Creates heap with all vars in [0; vars_num). Scores are not copied, so they should outlive the heap.
+ */
+VarHeap* create_var_heap(size_t vars_num, const double* scores);
+
+void free_var_heap(VarHeap* heap);
+
+/**
+ * Makes room for vars in [0; vars_num), which are not inserted. Scores may have been moved,
+ * so they are replaced by the given ones. Returns -1 if out of memory.
+ */
+int var_heap_grow(VarHeap* heap, size_t vars_num, const double* scores);
+
+static inline bool var_heap_is_empty(const VarHeap* heap) {
+    assert(heap != NULL);
+
+    return heap->len == 0;
+}
+
+static inline bool var_heap_contains(const VarHeap* heap, size_t var) {
+    assert(heap != NULL);
+    assertf(var < heap->capacity, "Expected var in [0; %zu), but got %zu", heap->capacity, var);
+
+    return heap->positions[var] != NOT_IN_HEAP;
+}
+
+void var_heap_insert(VarHeap* heap, size_t var);
+
+/**
+ * Restores heap order after the score of the var was increased.
+ */
+void var_heap_increased(VarHeap* heap, size_t var);
+
+size_t var_heap_pop_max(VarHeap* heap);
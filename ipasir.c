@@ -0,0 +1,266 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cnf.h"
+#include "debug.h"
+#include "dpll.h"
+#include "ipasir.h"
+
+#define IPASIR_ERROR(msg) do { \
+    fprintf(stderr, "IPASIR Error: " msg "\n"); \
+} while (0)
+
+#define IPASIR_SAT     10
+#define IPASIR_UNSAT   20
+#define IPASIR_UNKNOWN 0
+
+typedef struct LitVector {
+    signed int* lits;
+    size_t len;
+    size_t capacity;
+} LitVector;
+
+/**
+ * Clauses added before the first solve call are collected into a CNF, which the solver is created from.
+ * Later clauses are added to the solver directly.
+ */
+typedef struct IpasirSolver {
+    DpllOptions options;
+    DpllSolver* solver;
+    CNF* cnf;
+    LitVector clauses;     // Clauses before the first solve call, each one is terminated by zero
+    size_t clauses_num;
+    LitVector clause;      // Clause being added
+    LitVector assumptions; // Assumptions of the next solve call
+    size_t vars_num;       // Max var of clauses and assumptions
+    DpllResult result;     // Result of the last solve call
+    bool* model;
+    bool* failed;          // Failed assumptions of the last solve call indexed by cnf_lit_index
+    size_t values_capacity; // Vars in model and failed
+    bool has_error;        // Some clause was lost for lack of memory, so the solver cannot answer anymore
+} IpasirSolver;
+
+static int lit_vector_push(LitVector* vector, signed int lit) {
+    assert(vector != NULL);
+
+    if (vector->len == vector->capacity) {
+        size_t capacity = vector->capacity > 0 ? 2 * vector->capacity : 16;
+        signed int* lits = (signed int*) realloc(vector->lits, capacity * sizeof(signed int));
+        if (lits == NULL) {
+            IPASIR_ERROR("Insufficient memory");
+            return -1;
+        }
+        vector->lits = lits;
+        vector->capacity = capacity;
+    }
+    vector->lits[vector->len++] = lit;
+    return 0;
+}
+
+static void note_var(IpasirSolver* ipasir, signed int lit) {
+    size_t var = (size_t) (lit > 0 ? lit : -lit);
+    if (var > ipasir->vars_num) {
+        ipasir->vars_num = var;
+    }
+}
+
+/**
+ * Creates the solver from the clauses added so far.
+ */
+static int create_solver(IpasirSolver* ipasir) {
+    assert(ipasir != NULL);
+    assert(ipasir->solver == NULL);
+
+    ipasir->cnf = create_cnf(ipasir->vars_num, ipasir->clauses_num, ipasir->clauses.len);
+    if (ipasir->cnf == NULL) {
+        IPASIR_ERROR("Insufficient memory");
+        return -1;
+    }
+    const signed int* lits = ipasir->clauses.lits;
+    for (size_t start = 0, end = 0; end < ipasir->clauses.len; ++end) {
+        if (lits[end] == 0) {
+            if (cnf_add_clause(ipasir->cnf, lits + start, end - start) != 0) {
+                IPASIR_ERROR("Insufficient memory");
+                return -1;
+            }
+            start = end + 1;
+        }
+    }
+    ipasir->solver = dpll_create_solver(ipasir->cnf, &ipasir->options);
+    if (ipasir->solver == NULL) {
+        return -1;
+    }
+    free(ipasir->clauses.lits);
+    memset(&ipasir->clauses, 0, sizeof(LitVector));
+    return 0;
+}
+
+static int reserve_values(IpasirSolver* ipasir) {
+    assert(ipasir != NULL);
+
+    if (ipasir->model != NULL && ipasir->vars_num <= ipasir->values_capacity) {
+        return 0;
+    }
+    bool* model = (bool*) realloc(ipasir->model, (ipasir->vars_num + 1) * sizeof(bool));
+    if (model != NULL) {
+        ipasir->model = model;
+    }
+    bool* failed = (bool*) realloc(ipasir->failed, (2 * ipasir->vars_num + 1) * sizeof(bool));
+    if (failed != NULL) {
+        ipasir->failed = failed;
+    }
+    if (model == NULL || failed == NULL) {
+        IPASIR_ERROR("Insufficient memory");
+        return -1;
+    }
+    ipasir->values_capacity = ipasir->vars_num;
+    return 0;
+}
+
+const char* ipasir_signature(void) {
+    return "dpll";
+}
+
+void* ipasir_init(void) {
+    IpasirSolver* ipasir = (IpasirSolver*) calloc(1, sizeof(IpasirSolver));
+    if (ipasir == NULL) {
+        IPASIR_ERROR("Insufficient memory");
+        return NULL;
+    }
+    ipasir->options = dpll_default_options();
+    ipasir->result = UNKNOWN;
+    return ipasir;
+}
+
+void ipasir_release(void* solver) {
+    IpasirSolver* ipasir = (IpasirSolver*) solver;
+    if (ipasir != NULL) {
+        dpll_free_solver(ipasir->solver);
+        free_cnf(ipasir->cnf);
+        free(ipasir->clauses.lits);
+        free(ipasir->clause.lits);
+        free(ipasir->assumptions.lits);
+        free(ipasir->model);
+        free(ipasir->failed);
+        free(ipasir);
+    }
+}
+
+void ipasir_add(void* solver, int32_t lit_or_zero) {
+    IpasirSolver* ipasir = (IpasirSolver*) solver;
+    assert(ipasir != NULL);
+
+    ipasir->result = UNKNOWN;
+    if (lit_or_zero != 0) {
+        note_var(ipasir, lit_or_zero);
+        if (lit_vector_push(&ipasir->clause, lit_or_zero) != 0) {
+            ipasir->has_error = true;
+        }
+        return;
+    }
+
+    LitVector* clause = &ipasir->clause;
+    if (ipasir->solver == NULL) {
+        for (size_t i = 0; i < clause->len; ++i) {
+            ipasir->has_error = ipasir->has_error || lit_vector_push(&ipasir->clauses, clause->lits[i]) != 0;
+        }
+        ipasir->has_error = ipasir->has_error || lit_vector_push(&ipasir->clauses, 0) != 0;
+        ++ipasir->clauses_num;
+    } else if (dpll_add_vars(ipasir->solver, ipasir->vars_num) != 0
+               || dpll_add_clause(ipasir->solver, clause->lits, clause->len) != 0) {
+        ipasir->has_error = true;
+    }
+    clause->len = 0;
+}
+
+void ipasir_assume(void* solver, int32_t lit) {
+    IpasirSolver* ipasir = (IpasirSolver*) solver;
+    assert(ipasir != NULL);
+    assert(lit != 0);
+
+    note_var(ipasir, lit);
+    if (lit_vector_push(&ipasir->assumptions, lit) != 0) {
+        ipasir->has_error = true;
+    }
+}
+
+int ipasir_solve(void* solver) {
+    IpasirSolver* ipasir = (IpasirSolver*) solver;
+    assert(ipasir != NULL);
+
+    ipasir->result = ERROR;
+    LitVector* assumptions = &ipasir->assumptions;
+    if (!ipasir->has_error && ipasir->solver == NULL && create_solver(ipasir) != 0) {
+        ipasir->has_error = true;
+    }
+    if (!ipasir->has_error && (dpll_add_vars(ipasir->solver, ipasir->vars_num) != 0 || reserve_values(ipasir) != 0)) {
+        ipasir->has_error = true;
+    }
+    if (ipasir->has_error) {
+        IPASIR_ERROR("Solver lost clauses for lack of memory, so it cannot answer");
+        assumptions->len = 0;
+        return IPASIR_UNKNOWN;
+    }
+
+    ipasir->result = dpll_solve(ipasir->solver, assumptions->lits, assumptions->len);
+    if (ipasir->result == SAT) {
+        dpll_solver_model(ipasir->solver, ipasir->model);
+    } else if (ipasir->result == UNSAT) {
+        memset(ipasir->failed, 0, 2 * ipasir->vars_num * sizeof(bool));
+        size_t failed_num = 0;
+        const signed int* failed = dpll_solver_failed(ipasir->solver, &failed_num);
+        for (size_t i = 0; i < failed_num; ++i) {
+            ipasir->failed[cnf_lit_index(failed[i])] = true;
+        }
+    }
+    assumptions->len = 0;
+
+    switch (ipasir->result) {
+        case SAT:
+            return IPASIR_SAT;
+        case UNSAT:
+            return IPASIR_UNSAT;
+        default:
+            return IPASIR_UNKNOWN;
+    }
+}
+
+int32_t ipasir_val(void* solver, int32_t lit) {
+    IpasirSolver* ipasir = (IpasirSolver*) solver;
+    assert(ipasir != NULL);
+    assert(lit != 0);
+    assertf(ipasir->result == SAT, "Expected SAT state, but the last result is %d", ipasir->result);
+
+    size_t var = (size_t) (lit > 0 ? lit : -lit);
+    if (var > ipasir->values_capacity) {
+        return 0;
+    }
+    return ipasir->model[var - 1] == (lit > 0) ? lit : -lit;
+}
+
+int ipasir_failed(void* solver, int32_t lit) {
+    IpasirSolver* ipasir = (IpasirSolver*) solver;
+    assert(ipasir != NULL);
+    assert(lit != 0);
+    assertf(ipasir->result == UNSAT, "Expected UNSAT state, but the last result is %d", ipasir->result);
+
+    size_t var = (size_t) (lit > 0 ? lit : -lit);
+    return var <= ipasir->values_capacity && ipasir->failed[cnf_lit_index(lit)] ? 1 : 0;
+}
+
+void ipasir_set_terminate(void* solver, void* data, int (*terminate)(void* data)) {
+    IpasirSolver* ipasir = (IpasirSolver*) solver;
+    assert(ipasir != NULL);
+
+    ipasir->options.terminate = terminate;
+    ipasir->options.terminate_data = data;
+}
+
+void ipasir_set_learn(void* solver, void* data, int max_length, void (*learn)(void* data, int32_t* clause)) {
+    (void) solver;
+    (void) data;
+    (void) max_length;
+    (void) learn;
+}
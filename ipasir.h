@@ -0,0 +1,51 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * Incremental solver interface of the SAT competition (IPASIR). Literals are non-zero DIMACS numbers,
+ * new vars may appear in any added clause or assumption.
+ */
+
+const char* ipasir_signature(void);
+
+void* ipasir_init(void);
+
+void ipasir_release(void* solver);
+
+/**
+ * Adds a literal to the clause being built, zero ends the clause. Clauses are kept for all subsequent solve calls.
+ */
+void ipasir_add(void* solver, int32_t lit_or_zero);
+
+/**
+ * Assumes the literal to be true for the next solve call only.
+ */
+void ipasir_assume(void* solver, int32_t lit);
+
+/**
+ * Returns 10 if clauses are satisfiable under the assumptions, 20 if not, and 0 if search was terminated or failed.
+ * Learned clauses and heuristics state are kept for the next calls.
+ */
+int ipasir_solve(void* solver);
+
+/**
+ * Returns lit if it is true in the model found by the last solve call, -lit if it is false
+ * and 0 if its var is unknown to the solver. Valid only after solve returned 10.
+ */
+int32_t ipasir_val(void* solver, int32_t lit);
+
+/**
+ * Returns 1 if the assumed lit was used to refute the assumptions by the last solve call, 0 otherwise.
+ * Valid only after solve returned 20.
+ */
+int ipasir_failed(void* solver, int32_t lit);
+
+/**
+ * Sets callback, that is polled during search, and stops it once it returns non-zero (NULL removes it).
+ */
+void ipasir_set_terminate(void* solver, void* data, int (*terminate)(void* data));
+
+/**
+ * Learned clauses are not exported, so the callback is never called.
+ */
+void ipasir_set_learn(void* solver, void* data, int max_length, void (*learn)(void* data, int32_t* clause));
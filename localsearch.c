@@ -0,0 +1,422 @@
+#define  _GNU_SOURCE
+#include <assert.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "debug.h"
+#include "localsearch.h"
+
+#define LOCAL_SEARCH_ERROR(msg) do { \
+    fprintf(stderr, "Local Search Error: " msg "\n"); \
+} while (0)
+
+#define BUDGET_CHECK_INTERVAL 1024 // Flips between checks of time, terminate callback and progress
+#define POLY_BREAK_BASE 2.38       // Weight of a var is (POLY_BREAK_EPS + break)^-POLY_BREAK_BASE for 3-SAT
+#define POLY_BREAK_EPS 1.0
+#define DEFAULT_SEED 0x9E3779B97F4A7C15ULL
+
+// Weight of a var is base^-break for longer clauses, bases are tuned for uniform k-SAT by max clause length
+static const double exp_break_bases[] = {3.0, 3.7, 5.1, 5.4}; // 4-SAT to 7-SAT (and longer)
+
+typedef struct LocalSearch {
+    size_t vars_num;
+    size_t clauses_num;         // Clauses without tautologies
+    size_t* clause_starts;      // Literals of clause i are lits[clause_starts[i]] to lits[clause_starts[i + 1] - 1]
+    signed int* lits;           // Literals of all clauses without duplicates
+    size_t* occurance_starts;   // Clauses of literal l are occurances[occurance_starts[l]] and on (by literal index)
+    size_t* occurances;
+    bool* values;               // Current value of each var by var index
+    size_t* true_counts;        // Number of true literals of each clause
+    size_t* critical;           // Xor of vars of true literals of each clause, the only one of them, if there is one
+    size_t* breaks;             // Clauses, where the var is the only true one, so flipping it unsatisfies them
+    size_t* unsat;              // Unsatisfied clauses in any order
+    size_t unsat_num;
+    size_t* unsat_positions;    // Position of each unsatisfied clause in unsat
+    double* weights;            // Weight of a var by its break count
+    size_t max_break;
+    double* clause_weights;     // Weights of vars of the picked clause
+    bool* best;                 // Assignment with the fewest unsatisfied clauses found
+    size_t best_unsat_num;
+    size_t* changed;            // Vars flipped since the best assignment was stored, each at most once
+    size_t changed_num;
+    bool* is_changed;
+    uint64_t random_state;
+    size_t memory;              // Bytes allocated by the search
+    DpllStats stats;
+    struct timespec start;
+    double next_progress;       // Seconds since start
+} LocalSearch;
+
+static uint64_t next_random(LocalSearch* ls) {
+    assert(ls != NULL);
+
+    uint64_t x = ls->random_state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    ls->random_state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static double elapsed_seconds(const struct timespec* start) {
+    assert(start != NULL);
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) (now.tv_sec - start->tv_sec) + (double) (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static inline size_t var_index(signed int var) {
+    return (size_t) (var > 0 ? var : -var) - 1;
+}
+
+static inline bool is_true(const LocalSearch* ls, signed int var) {
+    return ls->values[var_index(var)] == (var > 0);
+}
+
+/**
+ * Returns clauses, that contain the literal, and stores their count in len.
+ */
+static inline const size_t* literal_occurances(const LocalSearch* ls, signed int lit, size_t* len) {
+    size_t lit_index = cnf_lit_index(lit);
+    *len = ls->occurance_starts[lit_index + 1] - ls->occurance_starts[lit_index];
+    return ls->occurances + ls->occurance_starts[lit_index];
+}
+
+static const signed int* local_clause_vars(const void* ls, size_t clause_num, size_t* len) {
+    const LocalSearch* search = (const LocalSearch*) ls;
+    *len = search->clause_starts[clause_num + 1] - search->clause_starts[clause_num];
+    return search->lits + search->clause_starts[clause_num];
+}
+
+static void* allocate(LocalSearch* ls, size_t len, size_t item_size) {
+    assert(ls != NULL);
+
+    ls->memory += len * item_size;
+    return calloc(len + 1, item_size);
+}
+
+static void free_local_search(LocalSearch* ls) {
+    if (ls != NULL) {
+        free(ls->clause_starts);
+        free(ls->lits);
+        free(ls->occurance_starts);
+        free(ls->occurances);
+        free(ls->values);
+        free(ls->true_counts);
+        free(ls->critical);
+        free(ls->breaks);
+        free(ls->unsat);
+        free(ls->unsat_positions);
+        free(ls->weights);
+        free(ls->clause_weights);
+        free(ls->best);
+        free(ls->changed);
+        free(ls->is_changed);
+        free(ls);
+    }
+}
+
+/**
+ * Copies clauses of the CNF without duplicate literals and tautologies, and groups them by literals.
+ * Returns -1 if out of memory.
+ */
+static int load_clauses(LocalSearch* ls, const CNF* cnf) {
+    assert(ls != NULL);
+    assert(cnf != NULL);
+
+    size_t lits_num = 2 * ls->vars_num;
+    size_t* stamps = (size_t*) calloc(lits_num + 1, sizeof(size_t)); // Clause number + 1 of the last literal occurance
+    ls->clause_starts = (size_t*) allocate(ls, cnf->clauses_num + 1, sizeof(size_t));
+    ls->lits = (signed int*) allocate(ls, cnf->vars_len, sizeof(signed int));
+    ls->occurance_starts = (size_t*) allocate(ls, lits_num + 1, sizeof(size_t));
+    ls->occurances = (size_t*) allocate(ls, cnf->vars_len, sizeof(size_t));
+    if (stamps == NULL || ls->clause_starts == NULL || ls->lits == NULL || ls->occurance_starts == NULL || ls->occurances == NULL) {
+        free(stamps);
+        return -1;
+    }
+
+    size_t lits_len = 0;
+    size_t max_len = 0;
+    for (size_t clause_num = 0; clause_num < cnf->clauses_num; ++clause_num) {
+        const Clause* clause = &cnf->clauses[clause_num];
+        const signed int* vars = cnf_clause_vars(cnf, clause);
+        size_t stamp = clause_num + 1;
+        size_t start = lits_len;
+        bool is_tautology = false;
+        for (size_t i = 0; i < clause->len && !is_tautology; ++i) {
+            if (stamps[cnf_lit_index(-vars[i])] == stamp) {
+                is_tautology = true;
+            } else if (stamps[cnf_lit_index(vars[i])] != stamp) {
+                stamps[cnf_lit_index(vars[i])] = stamp;
+                ls->lits[lits_len++] = vars[i];
+            }
+        }
+        if (is_tautology) {
+            lits_len = start;
+            continue;
+        }
+        if (lits_len - start > max_len) {
+            max_len = lits_len - start;
+        }
+        ls->clause_starts[ls->clauses_num++] = start;
+    }
+    ls->clause_starts[ls->clauses_num] = lits_len;
+    free(stamps);
+
+    build_occurances(ls, ls->clauses_num, local_clause_vars, lits_num, ls->occurance_starts, ls->occurances);
+    for (size_t i = 0; i < lits_num; ++i) {
+        size_t len = ls->occurance_starts[i + 1] - ls->occurance_starts[i];
+        if (len > ls->max_break) {
+            ls->max_break = len;
+        }
+    }
+    ls->clause_weights = (double*) allocate(ls, max_len, sizeof(double));
+    ls->weights = (double*) allocate(ls, ls->max_break + 1, sizeof(double));
+    if (ls->clause_weights == NULL || ls->weights == NULL) {
+        return -1;
+    }
+
+    // Polynomial break function suits 3-SAT, while exponential one suits longer clauses
+    for (size_t i = 0; i <= ls->max_break; ++i) {
+        if (max_len <= 3) {
+            ls->weights[i] = pow(POLY_BREAK_EPS + (double) i, -POLY_BREAK_BASE);
+        } else {
+            size_t base_num = sizeof(exp_break_bases) / sizeof(exp_break_bases[0]);
+            size_t base = max_len - 4 < base_num ? max_len - 4 : base_num - 1;
+            ls->weights[i] = pow(exp_break_bases[base], -(double) i);
+        }
+    }
+    return 0;
+}
+
+static LocalSearch* create_local_search(const CNF* cnf, const DpllOptions* options) {
+    assert(cnf != NULL);
+    assert(options != NULL);
+
+    LocalSearch* ls = (LocalSearch*) calloc(1, sizeof(LocalSearch));
+    if (ls == NULL) {
+        return NULL;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &ls->start);
+    ls->next_progress = options->progress_interval;
+    ls->memory = sizeof(LocalSearch);
+    ls->vars_num = cnf->vars_num;
+    ls->random_state = options->seed != 0 ? DEFAULT_SEED * options->seed : DEFAULT_SEED;
+    if (load_clauses(ls, cnf) != 0) {
+        free_local_search(ls);
+        return NULL;
+    }
+    ls->values = (bool*) allocate(ls, ls->vars_num, sizeof(bool));
+    ls->true_counts = (size_t*) allocate(ls, ls->clauses_num, sizeof(size_t));
+    ls->critical = (size_t*) allocate(ls, ls->clauses_num, sizeof(size_t));
+    ls->breaks = (size_t*) allocate(ls, ls->vars_num, sizeof(size_t));
+    ls->unsat = (size_t*) allocate(ls, ls->clauses_num, sizeof(size_t));
+    ls->unsat_positions = (size_t*) allocate(ls, ls->clauses_num, sizeof(size_t));
+    ls->best = (bool*) allocate(ls, ls->vars_num, sizeof(bool));
+    ls->changed = (size_t*) allocate(ls, ls->vars_num, sizeof(size_t));
+    ls->is_changed = (bool*) allocate(ls, ls->vars_num, sizeof(bool));
+    if (ls->values == NULL || ls->true_counts == NULL || ls->critical == NULL || ls->breaks == NULL || ls->unsat == NULL
+        || ls->unsat_positions == NULL || ls->best == NULL || ls->changed == NULL || ls->is_changed == NULL) {
+        free_local_search(ls);
+        return NULL;
+    }
+    ls->stats.peak_memory = ls->memory;
+    return ls;
+}
+
+static inline void add_unsat(LocalSearch* ls, size_t clause_num) {
+    ls->unsat_positions[clause_num] = ls->unsat_num;
+    ls->unsat[ls->unsat_num++] = clause_num;
+}
+
+/**
+ * Removes the clause from the unsatisfied ones by moving the last one in its place.
+ */
+static inline void remove_unsat(LocalSearch* ls, size_t clause_num) {
+    size_t last = ls->unsat[--ls->unsat_num];
+    size_t position = ls->unsat_positions[clause_num];
+    ls->unsat[position] = last;
+    ls->unsat_positions[last] = position;
+}
+
+/**
+ * Assigns every var randomly and counts true literals, critical vars and break counts from scratch.
+ */
+static void init_assignment(LocalSearch* ls) {
+    assert(ls != NULL);
+
+    for (size_t i = 0; i < ls->vars_num; ++i) {
+        ls->values[i] = (next_random(ls) >> 63) != 0;
+        ls->best[i] = ls->values[i];
+    }
+    for (size_t clause_num = 0; clause_num < ls->clauses_num; ++clause_num) {
+        size_t true_count = 0;
+        size_t critical = 0;
+        for (size_t i = ls->clause_starts[clause_num]; i < ls->clause_starts[clause_num + 1]; ++i) {
+            if (is_true(ls, ls->lits[i])) {
+                ++true_count;
+                critical ^= var_index(ls->lits[i]) + 1;
+            }
+        }
+        ls->true_counts[clause_num] = true_count;
+        ls->critical[clause_num] = critical;
+        if (true_count == 0) {
+            add_unsat(ls, clause_num);
+        } else if (true_count == 1) {
+            ++ls->breaks[critical - 1];
+        }
+    }
+    ls->best_unsat_num = ls->unsat_num;
+}
+
+/**
+ * Flips the var and updates counters of clauses, where either of its literals occurs.
+ */
+static void flip(LocalSearch* ls, size_t var) {
+    assert(ls != NULL);
+    assert(var < ls->vars_num);
+
+    ls->values[var] = !ls->values[var];
+    signed int made_true = ls->values[var] ? (signed int) (var + 1) : -(signed int) (var + 1);
+    size_t occurances_len = 0;
+    const size_t* clauses = literal_occurances(ls, made_true, &occurances_len);
+    for (size_t i = 0; i < occurances_len; ++i) {
+        size_t clause_num = clauses[i];
+        size_t true_count = ++ls->true_counts[clause_num];
+        if (true_count == 1) {
+            remove_unsat(ls, clause_num);
+            ++ls->breaks[var];
+        } else if (true_count == 2) {
+            // The only true var of the clause has a companion now
+            --ls->breaks[ls->critical[clause_num] - 1];
+        }
+        ls->critical[clause_num] ^= var + 1;
+    }
+
+    clauses = literal_occurances(ls, -made_true, &occurances_len);
+    for (size_t i = 0; i < occurances_len; ++i) {
+        size_t clause_num = clauses[i];
+        size_t true_count = --ls->true_counts[clause_num];
+        ls->critical[clause_num] ^= var + 1;
+        if (true_count == 0) {
+            add_unsat(ls, clause_num);
+            --ls->breaks[var];
+        } else if (true_count == 1) {
+            ++ls->breaks[ls->critical[clause_num] - 1];
+        }
+    }
+
+    if (!ls->is_changed[var]) {
+        ls->is_changed[var] = true;
+        ls->changed[ls->changed_num++] = var;
+    }
+}
+
+/**
+ * Picks a var of the clause with probability proportional to its weight by break count.
+ */
+static size_t pick_var(LocalSearch* ls, size_t clause_num) {
+    assert(ls != NULL);
+
+    size_t start = ls->clause_starts[clause_num];
+    size_t len = ls->clause_starts[clause_num + 1] - start;
+    double sum = 0.0;
+    for (size_t i = 0; i < len; ++i) {
+        sum += ls->weights[ls->breaks[var_index(ls->lits[start + i])]];
+        ls->clause_weights[i] = sum;
+    }
+    double point = (double) (next_random(ls) >> 11) * 0x1.0p-53 * sum;
+    size_t i = 0;
+    while (i + 1 < len && ls->clause_weights[i] <= point) {
+        ++i;
+    }
+    return var_index(ls->lits[start + i]);
+}
+
+/**
+ * Stores the current assignment as the best one by copying the vars flipped since the previous one.
+ */
+static void store_best(LocalSearch* ls) {
+    assert(ls != NULL);
+
+    for (size_t i = 0; i < ls->changed_num; ++i) {
+        size_t var = ls->changed[i];
+        ls->best[var] = ls->values[var];
+        ls->is_changed[var] = false;
+    }
+    ls->changed_num = 0;
+    ls->best_unsat_num = ls->unsat_num;
+}
+
+static bool should_stop(LocalSearch* ls, const DpllOptions* options, size_t flips_limit) {
+    assert(ls != NULL);
+    assert(options != NULL);
+
+    if (options->cancelled != NULL && atomic_load_explicit(options->cancelled, memory_order_relaxed)) {
+        return true;
+    }
+    if (flips_limit > 0 && ls->stats.flips >= flips_limit) {
+        return true;
+    }
+    if (ls->stats.flips % BUDGET_CHECK_INTERVAL != 0) {
+        return false;
+    }
+    double seconds = elapsed_seconds(&ls->start);
+    if (options->progress != NULL && seconds >= ls->next_progress) {
+        ls->next_progress = seconds + options->progress_interval;
+        ls->stats.search_time = seconds;
+        options->progress(&ls->stats, options->progress_data);
+    }
+    return (options->terminate != NULL && options->terminate(options->terminate_data) != 0)
+        || (options->time_limit > 0.0 && seconds >= options->time_limit);
+}
+
+DpllResult local_search(const CNF* cnf, const DpllOptions* options, size_t flips_limit, DpllStats* stats, bool* assignment) {
+    assert(cnf != NULL);
+    assert(options != NULL);
+
+    for (size_t i = 0; i < cnf->clauses_num; ++i) {
+        if (cnf->clauses[i].len == 0) {
+            return UNSAT;
+        }
+    }
+    LocalSearch* ls = create_local_search(cnf, options);
+    if (ls == NULL) {
+        LOCAL_SEARCH_ERROR("Insufficient memory");
+        return ERROR;
+    }
+    DpllResult result = UNKNOWN;
+    if (options->memory_limit > 0 && ls->memory > options->memory_limit) {
+        goto exit;
+    }
+
+    init_assignment(ls);
+    while (ls->unsat_num > 0 && !should_stop(ls, options, flips_limit)) {
+        size_t clause_num = ls->unsat[next_random(ls) % ls->unsat_num];
+        flip(ls, pick_var(ls, clause_num));
+        ++ls->stats.flips;
+        if (ls->unsat_num < ls->best_unsat_num) {
+            store_best(ls);
+        }
+    }
+    if (ls->unsat_num == 0) {
+        result = SAT;
+    }
+    DEBUG_PRINTF("Local search made %zu flips, best assignment has %zu unsatisfied clauses", ls->stats.flips, ls->best_unsat_num);
+
+exit:
+    ls->stats.search_time = elapsed_seconds(&ls->start);
+    if (assignment != NULL) {
+        memcpy(assignment, ls->best, ls->vars_num * sizeof(bool));
+    }
+    if (stats != NULL) {
+        *stats = ls->stats;
+    }
+    free_local_search(ls);
+    return result;
+}
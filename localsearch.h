@@ -0,0 +1,15 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include "cnf.h"
+#include "dpll.h"
+
+/**
+ * probSAT local search: starts from a random assignment and flips a var of a random unsatisfied clause,
+ * picked with probability, that falls with the number of clauses the flip breaks, until every clause
+ * is satisfied. Returns SAT, UNSAT only if the CNF has an empty clause, and UNKNOWN, once flips_limit flips
+ * (0 means no limit) or any time budget of the options is exhausted, or search is cancelled.
+ * If assignment is not NULL, value of var i in the assignment with the fewest unsatisfied clauses found
+ * (a model on SAT) is stored in assignment[i - 1]. Flips, time and memory are stored in stats (may be NULL).
+ */
+DpllResult local_search(const CNF* cnf, const DpllOptions* options, size_t flips_limit, DpllStats* stats, bool* assignment);
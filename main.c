@@ -1,16 +1,441 @@
+#define  _GNU_SOURCE
+#include <errno.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
 #include "debug.h"
 #include "cnf.h"
+#include "cube.h"
 #include "dpll.h"
+#include "portfolio.h"
+#include "preprocess.h"
+#include "proof.h"
+
+#define EXIT_UNKNOWN 2 // Budget was exhausted or search was interrupted, so the CNF may be retried with more resources
+#define DEFAULT_PROGRESS_INTERVAL 1.0 // Seconds
+
+typedef struct PhaseTimes {
+    double parse;      // Seconds, reading included
+    double preprocess;
+    double search;
+    double total;
+} PhaseTimes;
+
+static atomic_bool interrupted = false;
+
+static void handle_interrupt(int signal_number) {
+    (void) signal_number;
+    atomic_store(&interrupted, true);
+}
+
+/**
+ * The first SIGINT or SIGTERM stops search with UNKNOWN result, the second one kills the process as usual.
+ */
+static void set_interrupt_handlers(void) {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_interrupt;
+    action.sa_flags = SA_RESETHAND;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+}
+
+static double elapsed_seconds(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) (now.tv_sec - start->tv_sec) + (double) (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void print_usage(const char* program_name) {
+    fprintf(stderr, "Usage: %s [options] input.cnf\n", program_name);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  --mode=cdcl|dpll|local       search algorithm: conflict-driven clause learning (default), plain DPLL\n");
+    fprintf(stderr, "                               or probSAT local search (answers SAT or UNKNOWN)\n");
+    fprintf(stderr, "  --branching=vsids|ordered    branching heuristic: highest activity var (default) or lowest numbered var\n");
+    fprintf(stderr, "  --restarts=none|luby|glucose restart policy for CDCL search (default: glucose)\n");
+    fprintf(stderr, "  --luby-unit=N                number of conflicts multiplied by Luby sequence (default: 100)\n");
+    fprintf(stderr, "  --[no-]phase-saving          decide the last value a var had (default: on)\n");
+    fprintf(stderr, "  --[no-]probing               fix failed literals at the root before search and between restarts (default: on)\n");
+    fprintf(stderr, "  --local-search=FLIPS         start search from the best assignment of FLIPS local search flips\n");
+    fprintf(stderr, "                               (default: 0, no local search), limits flips of --mode=local\n");
+    fprintf(stderr, "  --threads=N                  run N differently configured searches in parallel (default: 1)\n");
+    fprintf(stderr, "  --cubes[=DEPTH]              split CNF into cubes of up to DEPTH vars solved by --threads workers\n");
+    fprintf(stderr, "                               (default depth: log2(threads) + 4)\n");
+    fprintf(stderr, "  --[no-]preprocess            simplify CNF before search (default: on)\n");
+    fprintf(stderr, "  --preprocess-time=SECONDS    time limit of each preprocessing step (default: 1)\n");
+    fprintf(stderr, "  --time-limit=SECONDS         answer UNKNOWN after SECONDS since start (default: no limit)\n");
+    fprintf(stderr, "  --max-conflicts=N            answer UNKNOWN after N conflicts (default: no limit)\n");
+    fprintf(stderr, "  --max-decisions=N            answer UNKNOWN after N decisions (default: no limit)\n");
+    fprintf(stderr, "  --max-memory=MB              answer UNKNOWN once the solver uses more than MB megabytes (default: no limit)\n");
+    fprintf(stderr, "  --stats                      print search statistics as DIMACS comment lines\n");
+    fprintf(stderr, "  --stats-json=FILE            write search statistics to FILE as JSON object\n");
+    fprintf(stderr, "  --progress[=SECONDS]         print search statistics as DIMACS comment line every SECONDS (default: 1)\n");
+    fprintf(stderr, "  --proof=FILE                 write DRAT proof of UNSAT answer to FILE (single search only)\n");
+    fprintf(stderr, "  --proof-format=binary|text   encoding of DRAT proof (default: binary)\n");
+    fprintf(stderr, "Exit code is 0 for SAT and UNSAT, %d for UNKNOWN (budget exhausted or interrupted) and 1 on error\n", EXIT_UNKNOWN);
+}
+
+static int parse_size(const char* str, size_t* value) {
+    char* end = NULL;
+    errno = 0;
+    unsigned long long parsed = strtoull(str, &end, 10);
+    if (errno != 0 || end == str || *end != '\0' || str[0] == '-') {
+        return -1;
+    }
+    *value = (size_t) parsed;
+    return 0;
+}
+
+static int parse_seconds(const char* str, double* value) {
+    char* end = NULL;
+    errno = 0;
+    double parsed = strtod(str, &end);
+    if (errno != 0 || end == str || *end != '\0' || !(parsed >= 0.0)) {
+        return -1;
+    }
+    *value = parsed;
+    return 0;
+}
+
+static void print_preprocess_stats(const PreprocessStats* stats) {
+    printf("c vars            %zu -> %zu\n", stats->vars_before, stats->vars_after);
+    printf("c clauses         %zu -> %zu\n", stats->clauses_before, stats->clauses_after);
+    printf("c substituted     %zu vars in %.3f s\n", stats->substituted_vars, stats->substitution_time);
+    printf("c subsumed        %zu clauses in %.3f s\n", stats->subsumed_clauses, stats->subsumption_time);
+    printf("c strengthened    %zu clauses in %.3f s\n", stats->strengthened_clauses, stats->strengthening_time);
+    printf("c eliminated      %zu vars in %.3f s\n", stats->eliminated_vars, stats->elimination_time);
+}
+
+/**
+ * Returns peak resident set size of the process in bytes (0 if unknown).
+ */
+static size_t peak_rss(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return (size_t) usage.ru_maxrss * 1024;
+}
+
+static const char* result_name(DpllResult result) {
+    switch (result) {
+        case SAT:
+            return "SAT";
+        case UNSAT:
+            return "UNSAT";
+        case UNKNOWN:
+            return "UNKNOWN";
+        default:
+            return "ERROR";
+    }
+}
+
+static void print_stats(const DpllStats* stats, const PhaseTimes* times) {
+    printf("c decisions       %zu\n", stats->decisions);
+    printf("c propagations    %zu\n", stats->propagations);
+    printf("c conflicts       %zu\n", stats->conflicts);
+    printf("c backtracks      %zu\n", stats->backtracks);
+    printf("c max depth       %zu\n", stats->max_depth);
+    printf("c learned clauses %zu\n", stats->learned_clauses);
+    printf("c deleted clauses %zu\n", stats->deleted_clauses);
+    printf("c reductions      %zu\n", stats->reductions);
+    printf("c restarts        %zu\n", stats->restarts);
+    printf("c probed units    %zu\n", stats->probed_units);
+    printf("c flips           %zu\n", stats->flips);
+    printf("c solver memory   %.1f MB\n", (double) stats->peak_memory / (1024.0 * 1024.0));
+    printf("c peak RSS        %.1f MB\n", (double) peak_rss() / (1024.0 * 1024.0));
+    printf("c parse time      %.3f s\n", times->parse);
+    printf("c preprocess time %.3f s\n", times->preprocess);
+    printf("c search time     %.3f s\n", times->search);
+    printf("c total time      %.3f s\n", times->total);
+}
+
+static void print_progress(const DpllStats* stats, void* data) {
+    (void) data;
+    printf("c progress %8.1f s  decisions %zu  conflicts %zu  propagations %zu  learned %zu  restarts %zu  depth %zu  memory %.1f MB\n",
+           stats->search_time, stats->decisions, stats->conflicts, stats->propagations, stats->learned_clauses,
+           stats->restarts, stats->max_depth, (double) stats->peak_memory / (1024.0 * 1024.0));
+    fflush(stdout);
+}
+
+/**
+ * Writes result and statistics as a JSON object, preprocess_stats may be NULL. Returns -1 on failure.
+ */
+static int write_stats_json(const char* path, DpllResult result, const DpllStats* stats,
+                            const PreprocessStats* preprocess_stats, const PhaseTimes* times) {
+    FILE* fp = fopen(path, "w");
+    if (fp == NULL) {
+        return -1;
+    }
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"result\": \"%s\",\n", result_name(result));
+    fprintf(fp, "  \"decisions\": %zu,\n", stats->decisions);
+    fprintf(fp, "  \"propagations\": %zu,\n", stats->propagations);
+    fprintf(fp, "  \"conflicts\": %zu,\n", stats->conflicts);
+    fprintf(fp, "  \"backtracks\": %zu,\n", stats->backtracks);
+    fprintf(fp, "  \"max_depth\": %zu,\n", stats->max_depth);
+    fprintf(fp, "  \"learned_clauses\": %zu,\n", stats->learned_clauses);
+    fprintf(fp, "  \"deleted_clauses\": %zu,\n", stats->deleted_clauses);
+    fprintf(fp, "  \"reductions\": %zu,\n", stats->reductions);
+    fprintf(fp, "  \"restarts\": %zu,\n", stats->restarts);
+    fprintf(fp, "  \"probed_units\": %zu,\n", stats->probed_units);
+    fprintf(fp, "  \"flips\": %zu,\n", stats->flips);
+    fprintf(fp, "  \"solver_memory_bytes\": %zu,\n", stats->peak_memory);
+    fprintf(fp, "  \"peak_rss_bytes\": %zu,\n", peak_rss());
+    if (preprocess_stats != NULL) {
+        fprintf(fp, "  \"preprocess\": {\n");
+        fprintf(fp, "    \"vars_before\": %zu,\n", preprocess_stats->vars_before);
+        fprintf(fp, "    \"vars_after\": %zu,\n", preprocess_stats->vars_after);
+        fprintf(fp, "    \"clauses_before\": %zu,\n", preprocess_stats->clauses_before);
+        fprintf(fp, "    \"clauses_after\": %zu,\n", preprocess_stats->clauses_after);
+        fprintf(fp, "    \"substituted_vars\": %zu,\n", preprocess_stats->substituted_vars);
+        fprintf(fp, "    \"subsumed_clauses\": %zu,\n", preprocess_stats->subsumed_clauses);
+        fprintf(fp, "    \"strengthened_clauses\": %zu,\n", preprocess_stats->strengthened_clauses);
+        fprintf(fp, "    \"eliminated_vars\": %zu,\n", preprocess_stats->eliminated_vars);
+        fprintf(fp, "    \"substitution_time\": %.6f,\n", preprocess_stats->substitution_time);
+        fprintf(fp, "    \"subsumption_time\": %.6f,\n", preprocess_stats->subsumption_time);
+        fprintf(fp, "    \"strengthening_time\": %.6f,\n", preprocess_stats->strengthening_time);
+        fprintf(fp, "    \"elimination_time\": %.6f\n", preprocess_stats->elimination_time);
+        fprintf(fp, "  },\n");
+    }
+    fprintf(fp, "  \"time\": {\n");
+    fprintf(fp, "    \"parse\": %.6f,\n", times->parse);
+    fprintf(fp, "    \"preprocess\": %.6f,\n", times->preprocess);
+    fprintf(fp, "    \"search\": %.6f,\n", times->search);
+    fprintf(fp, "    \"total\": %.6f\n", times->total);
+    fprintf(fp, "  }\n");
+    fprintf(fp, "}\n");
+    return fclose(fp) == 0 ? 0 : -1;
+}
+
+static int parse_options(int argc, char* argv[], DpllOptions* options, PreprocessOptions* preprocess_options,
+                         size_t* threads_num, bool* cubes_flag, size_t* cubes_depth, bool* preprocess_flag, bool* print_stats_flag,
+                         const char** stats_json_path, const char** proof_path, ProofFormat* proof_format) {
+    static const struct option long_options[] = {
+        {"mode",             required_argument, NULL, 'm'},
+        {"branching",        required_argument, NULL, 'b'},
+        {"restarts",         required_argument, NULL, 'r'},
+        {"luby-unit",        required_argument, NULL, 'u'},
+        {"phase-saving",     no_argument,       NULL, 'p'},
+        {"no-phase-saving",  no_argument,       NULL, 'P'},
+        {"probing",          no_argument,       NULL, 'o'},
+        {"no-probing",       no_argument,       NULL, 'O'},
+        {"local-search",     required_argument, NULL, 'l'},
+        {"threads",          required_argument, NULL, 'j'},
+        {"cubes",            optional_argument, NULL, 'c'},
+        {"preprocess",       no_argument,       NULL, 'e'},
+        {"no-preprocess",    no_argument,       NULL, 'E'},
+        {"preprocess-time",  required_argument, NULL, 't'},
+        {"time-limit",       required_argument, NULL, 'T'},
+        {"max-conflicts",    required_argument, NULL, 'C'},
+        {"max-decisions",    required_argument, NULL, 'D'},
+        {"max-memory",       required_argument, NULL, 'M'},
+        {"stats",            no_argument,       NULL, 's'},
+        {"stats-json",       required_argument, NULL, 'J'},
+        {"progress",         optional_argument, NULL, 'g'},
+        {"proof",            required_argument, NULL, 'f'},
+        {"proof-format",     required_argument, NULL, 'F'},
+        {"help",             no_argument,       NULL, 'h'},
+        {NULL,               0,                 NULL, 0},
+    };
+
+    int option = 0;
+    while ((option = getopt_long(argc, argv, "h", long_options, NULL)) != -1) {
+        switch (option) {
+            case 'm':
+                if (strcmp(optarg, "cdcl") == 0) {
+                    options->mode = SEARCH_CDCL;
+                } else if (strcmp(optarg, "dpll") == 0) {
+                    options->mode = SEARCH_DPLL;
+                } else if (strcmp(optarg, "local") == 0) {
+                    options->mode = SEARCH_LOCAL;
+                } else {
+                    fprintf(stderr, "Unknown search mode '%s'\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'b':
+                if (strcmp(optarg, "vsids") == 0) {
+                    options->branching = BRANCHING_VSIDS;
+                } else if (strcmp(optarg, "ordered") == 0) {
+                    options->branching = BRANCHING_ORDERED;
+                } else {
+                    fprintf(stderr, "Unknown branching heuristic '%s'\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'r':
+                if (strcmp(optarg, "none") == 0) {
+                    options->restarts = RESTARTS_NONE;
+                } else if (strcmp(optarg, "luby") == 0) {
+                    options->restarts = RESTARTS_LUBY;
+                } else if (strcmp(optarg, "glucose") == 0) {
+                    options->restarts = RESTARTS_GLUCOSE;
+                } else {
+                    fprintf(stderr, "Unknown restart policy '%s'\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'u':
+                if (parse_size(optarg, &options->luby_unit) != 0 || options->luby_unit == 0) {
+                    fprintf(stderr, "Expected positive Luby unit, but got '%s'\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'p':
+                options->phase_saving = true;
+                break;
+            case 'P':
+                options->phase_saving = false;
+                break;
+            case 'o':
+                options->probing = true;
+                break;
+            case 'O':
+                options->probing = false;
+                break;
+            case 'l':
+                if (parse_size(optarg, &options->local_search_flips) != 0) {
+                    fprintf(stderr, "Expected number of flips, but got '%s'\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'j':
+                if (parse_size(optarg, threads_num) != 0 || *threads_num == 0) {
+                    fprintf(stderr, "Expected positive number of threads, but got '%s'\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'c':
+                *cubes_flag = true;
+                if (optarg != NULL && (parse_size(optarg, cubes_depth) != 0 || *cubes_depth == 0)) {
+                    fprintf(stderr, "Expected positive cube depth, but got '%s'\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'e':
+                *preprocess_flag = true;
+                break;
+            case 'E':
+                *preprocess_flag = false;
+                break;
+            case 't':
+                if (parse_seconds(optarg, &preprocess_options->subsumption_time_limit) != 0) {
+                    fprintf(stderr, "Expected non-negative number of seconds, but got '%s'\n", optarg);
+                    return -1;
+                }
+                preprocess_options->strengthening_time_limit = preprocess_options->subsumption_time_limit;
+                preprocess_options->elimination_time_limit = preprocess_options->subsumption_time_limit;
+                break;
+            case 'T':
+                if (parse_seconds(optarg, &options->time_limit) != 0 || options->time_limit == 0.0) {
+                    fprintf(stderr, "Expected positive number of seconds, but got '%s'\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'C':
+                if (parse_size(optarg, &options->conflicts_limit) != 0 || options->conflicts_limit == 0) {
+                    fprintf(stderr, "Expected positive number of conflicts, but got '%s'\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'D':
+                if (parse_size(optarg, &options->decisions_limit) != 0 || options->decisions_limit == 0) {
+                    fprintf(stderr, "Expected positive number of decisions, but got '%s'\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'M': {
+                size_t megabytes = 0;
+                if (parse_size(optarg, &megabytes) != 0 || megabytes == 0 || megabytes > SIZE_MAX / (1024 * 1024)) {
+                    fprintf(stderr, "Expected positive number of megabytes, but got '%s'\n", optarg);
+                    return -1;
+                }
+                options->memory_limit = megabytes * 1024 * 1024;
+                break;
+            }
+            case 's':
+                *print_stats_flag = true;
+                break;
+            case 'J':
+                *stats_json_path = optarg;
+                break;
+            case 'g':
+                options->progress = print_progress;
+                options->progress_interval = DEFAULT_PROGRESS_INTERVAL;
+                if (optarg != NULL && (parse_seconds(optarg, &options->progress_interval) != 0 || options->progress_interval == 0.0)) {
+                    fprintf(stderr, "Expected positive number of seconds, but got '%s'\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'f':
+                *proof_path = optarg;
+                break;
+            case 'F':
+                if (strcmp(optarg, "binary") == 0) {
+                    *proof_format = PROOF_BINARY;
+                } else if (strcmp(optarg, "text") == 0) {
+                    *proof_format = PROOF_TEXT;
+                } else {
+                    fprintf(stderr, "Unknown proof format '%s'\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'h':
+            default:
+                return -1;
+        }
+    }
+    return 0;
+}
 
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        fprintf(stderr, "Expected 1 argument, but got %d\n", argc - 1);
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    DpllOptions options = dpll_default_options();
+    PreprocessOptions preprocess_options = preprocess_default_options();
+    size_t threads_num = 1;
+    bool cubes_flag = false;
+    size_t cubes_depth = 0;
+    bool preprocess_flag = true;
+    bool print_stats_flag = false;
+    const char* stats_json_path = NULL;
+    const char* proof_path = NULL;
+    ProofFormat proof_format = PROOF_BINARY;
+    if (parse_options(argc, argv, &options, &preprocess_options, &threads_num, &cubes_flag, &cubes_depth, &preprocess_flag,
+                      &print_stats_flag, &stats_json_path, &proof_path, &proof_format) != 0) {
+        print_usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    if (proof_path != NULL && (cubes_flag || threads_num > 1)) {
+        fprintf(stderr, "Proof is written by a single search only, so --proof excludes --threads and --cubes\n");
+        exit(EXIT_FAILURE);
+    }
+    if (proof_path != NULL && options.mode == SEARCH_LOCAL) {
+        fprintf(stderr, "Local search never proves UNSAT, so --proof excludes --mode=local\n");
+        exit(EXIT_FAILURE);
+    }
+    if (cubes_flag && (options.mode == SEARCH_LOCAL || options.local_search_flips > 0)) {
+        fprintf(stderr, "Cubes are solved by systematic search without local search, so --cubes excludes --mode=local and --local-search\n");
+        exit(EXIT_FAILURE);
+    }
+    if (argc - optind != 1) {
+        fprintf(stderr, "Expected 1 argument, but got %d\n", argc - optind);
+        print_usage(argv[0]);
         exit(EXIT_FAILURE);
     }
+    options.cancelled = &interrupted;
+    set_interrupt_handlers();
 
-    char* file_name = argv[1];
+    char* file_name = argv[optind];
     FILE* fp = fopen(file_name, "r");
     if (fp == NULL) {
         fprintf(stderr, "fopen() returned NULL for file '%s'\n", file_name);
@@ -23,14 +448,31 @@ int main(int argc, char* argv[]) {
         fprintf(stderr, "Bad CNF syntax in file '%s'\n", file_name);
         exit(EXIT_FAILURE);
     }
+    PhaseTimes times = {0};
+    times.parse = elapsed_seconds(&start);
+
+    Proof* proof = NULL;
+    if (proof_path != NULL) {
+        FILE* proof_fp = fopen(proof_path, "wb");
+        if (proof_fp == NULL) {
+            fprintf(stderr, "fopen() returned NULL for file '%s'\n", proof_path);
+            exit(EXIT_FAILURE);
+        }
+        proof = create_proof(proof_fp, proof_format);
+        if (proof == NULL) {
+            exit(EXIT_FAILURE);
+        }
+        options.proof = proof;
+        preprocess_options.proof = proof;
+    }
 
     DEBUG_PRINTF("Vars num: %zu", cnf->vars_num);
     DEBUG_PRINTF("Clauses num: %zu", cnf->clauses_num);
     #ifdef DEBUG
     for (size_t i = 0; i < cnf->clauses_num; ++i) {
-        Clause* clause = cnf->clauses[i];
+        Clause* clause = &cnf->clauses[i];
         size_t vars_num = clause->len;
-        signed int* vars = clause->vars;
+        signed int* vars = cnf_clause_vars(cnf, clause);
         printf("   ");
         for (size_t j = 0; j < vars_num; ++j) {
             printf(" %d", vars[j]);
@@ -39,9 +481,71 @@ int main(int argc, char* argv[]) {
     }
     #endif
 
-    DpllResult result = dpll_check_sat(cnf);
+    PreprocessStats preprocess_stats = {0};
+    ModelStack* model_stack = NULL;
+    CNF* preprocessed_cnf = NULL;
+    bool* model = NULL;
+    if (preprocess_flag) {
+        model_stack = create_model_stack();
+        model = (bool*) calloc(cnf->vars_num + 1, sizeof(bool));
+        if (model_stack == NULL || model == NULL) {
+            fprintf(stderr, "Insufficient memory\n");
+            exit(EXIT_FAILURE);
+        }
+        preprocessed_cnf = preprocess_cnf(cnf, &preprocess_options, model_stack, &preprocess_stats);
+        if (preprocessed_cnf == NULL) {
+            fprintf(stderr, "Preprocessing exited with error\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    times.preprocess = elapsed_seconds(&start) - times.parse;
+
+    DpllStats stats = {0};
+    const CNF* search_cnf = preprocessed_cnf != NULL ? preprocessed_cnf : cnf;
+    DpllResult result = ERROR;
+    bool has_time_limit = options.time_limit > 0.0;
+    if (has_time_limit) {
+        // Time limit counts from start, so parsing and preprocessing are charged to it too
+        options.time_limit -= elapsed_seconds(&start);
+    }
+    if ((has_time_limit && options.time_limit <= 0.0) || atomic_load(&interrupted)) {
+        result = UNKNOWN;
+    } else if (cubes_flag) {
+        result = cube_check_sat(search_cnf, &options, threads_num, cubes_depth, &stats, model);
+    } else if (threads_num > 1) {
+        result = portfolio_check_sat(search_cnf, &options, threads_num, &stats, model);
+    } else {
+        result = dpll_check_sat(search_cnf, &options, &stats, model);
+    }
+    times.search = elapsed_seconds(&start) - times.parse - times.preprocess;
+    if (result == SAT && preprocess_flag) {
+        reconstruct_model(model_stack, model);
+        assertf(cnf_is_satisfied_by(cnf, model), "Reconstructed model does not satisfy CNF (%zu substituted, %zu eliminated vars)",
+                preprocess_stats.substituted_vars, preprocess_stats.eliminated_vars);
+    }
 
+    free_cnf(preprocessed_cnf);
+    free_model_stack(model_stack);
+    free(model);
     free_cnf(cnf);
+    if (close_proof(proof) != 0) {
+        // Answer without the requested certificate is not trusted
+        fprintf(stderr, "Failed to write proof to '%s'\n", proof_path);
+        exit(EXIT_FAILURE);
+    }
+    times.total = elapsed_seconds(&start);
+
+    if (print_stats_flag) {
+        if (preprocess_flag) {
+            print_preprocess_stats(&preprocess_stats);
+        }
+        print_stats(&stats, &times);
+    }
+    if (stats_json_path != NULL
+        && write_stats_json(stats_json_path, result, &stats, preprocess_flag ? &preprocess_stats : NULL, &times) != 0) {
+        // Answer is still printed, stats are not worth losing it
+        fprintf(stderr, "Failed to write stats to '%s'\n", stats_json_path);
+    }
 
     switch (result) {
         case SAT:
@@ -50,6 +554,9 @@ int main(int argc, char* argv[]) {
         case UNSAT:
             printf("UNSAT");
             return 0;
+        case UNKNOWN:
+            printf("UNKNOWN");
+            return EXIT_UNKNOWN;
         case ERROR:
             fprintf(stderr, "DPLL exited with error\n");
             exit(EXIT_FAILURE);
@@ -58,4 +565,3 @@ int main(int argc, char* argv[]) {
             exit(EXIT_FAILURE);
     }
 }
-
@@ -0,0 +1,144 @@
+#define  _GNU_SOURCE
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "debug.h"
+#include "portfolio.h"
+
+#define PORTFOLIO_ERROR(msg) do { \
+    fprintf(stderr, "Portfolio Error: " msg "\n"); \
+} while (0)
+
+#define NO_WINNER ((size_t) -1)
+
+typedef struct Portfolio {
+    atomic_bool cancelled; // Set by the first finished worker
+    atomic_size_t winner;  // Index of the first worker, that found the answer, or NO_WINNER
+} Portfolio;
+
+typedef struct PortfolioWorker {
+    pthread_t thread;
+    size_t index;
+    const CNF* cnf;
+    DpllOptions options;
+    DpllStats stats;
+    DpllResult result;
+    bool* model;
+    Portfolio* portfolio;
+} PortfolioWorker;
+
+/**
+ * Workers differ in restart policy, initial phases and seeded initial var order. The first one runs
+ * the given configuration as is, so the portfolio is never worse than the single-threaded search.
+ */
+static void diversify_options(DpllOptions* options, size_t index) {
+    assert(options != NULL);
+
+    if (index == 0) {
+        return;
+    }
+    static const InitialPhase phases[] = {PHASE_FALSE, PHASE_RANDOM, PHASE_TRUE};
+    options->seed = (unsigned int) index;
+    options->restarts = index % 2 == 1 ? RESTARTS_LUBY : RESTARTS_GLUCOSE;
+    options->luby_unit = index % 4 == 1 ? 100 : 512;
+    options->initial_phase = phases[(index / 2) % 3];
+}
+
+static void* run_worker(void* arg) {
+    PortfolioWorker* worker = (PortfolioWorker*) arg;
+    Portfolio* portfolio = worker->portfolio;
+
+    worker->result = dpll_check_sat(worker->cnf, &worker->options, &worker->stats, worker->model);
+    if (worker->result == SAT || worker->result == UNSAT) {
+        size_t no_winner = NO_WINNER;
+        atomic_compare_exchange_strong(&portfolio->winner, &no_winner, worker->index);
+        atomic_store(&portfolio->cancelled, true);
+    }
+    return NULL;
+}
+
+DpllResult portfolio_check_sat(const CNF* cnf, const DpllOptions* options, size_t threads_num, DpllStats* stats, bool* model) {
+    assert(cnf != NULL);
+    assert(options != NULL);
+    assert(threads_num > 0);
+
+    DpllResult result = ERROR;
+    size_t started_num = 0;
+    Portfolio portfolio;
+    atomic_init(&portfolio.cancelled, false);
+    atomic_init(&portfolio.winner, NO_WINNER);
+
+    PortfolioWorker* workers = (PortfolioWorker*) calloc(threads_num, sizeof(PortfolioWorker));
+    if (workers == NULL) {
+        PORTFOLIO_ERROR("Insufficient memory");
+        goto exit;
+    }
+    for (size_t i = 0; i < threads_num; ++i) {
+        PortfolioWorker* worker = &workers[i];
+        worker->index = i;
+        worker->cnf = cnf;
+        worker->options = *options;
+        worker->options.cancelled = &portfolio.cancelled;
+        worker->options.terminate = dpll_options_terminated;
+        worker->options.terminate_data = (void*) options;
+        // Lemmas of concurrent searches do not make a proof of the whole CNF
+        worker->options.proof = NULL;
+        if (i > 0) {
+            // Progress of the first worker stands for the whole portfolio
+            worker->options.progress = NULL;
+        }
+        worker->portfolio = &portfolio;
+        diversify_options(&worker->options, i);
+        if (model != NULL) {
+            worker->model = (bool*) calloc(cnf->vars_num + 1, sizeof(bool));
+            if (worker->model == NULL) {
+                PORTFOLIO_ERROR("Insufficient memory");
+                goto exit;
+            }
+        }
+    }
+
+    for (; started_num < threads_num; ++started_num) {
+        if (pthread_create(&workers[started_num].thread, NULL, run_worker, &workers[started_num]) != 0) {
+            PORTFOLIO_ERROR("Failed to start worker thread");
+            atomic_store(&portfolio.cancelled, true);
+            break;
+        }
+    }
+    for (size_t i = 0; i < started_num; ++i) {
+        pthread_join(workers[i].thread, NULL);
+    }
+
+    size_t winner = atomic_load(&portfolio.winner);
+    if (winner != NO_WINNER) {
+        PortfolioWorker* worker = &workers[winner];
+        result = worker->result;
+        DEBUG_PRINTF("Portfolio worker %zu found the answer", winner);
+        if (stats != NULL) {
+            *stats = worker->stats;
+        }
+        if (model != NULL && result == SAT) {
+            memcpy(model, worker->model, cnf->vars_num * sizeof(bool));
+        }
+    } else if (started_num == threads_num) {
+        // Nobody found the answer, so every worker either failed or was cancelled from outside
+        result = UNKNOWN;
+        for (size_t i = 0; i < threads_num; ++i) {
+            if (workers[i].result == ERROR) {
+                result = ERROR;
+            }
+        }
+    }
+
+exit:
+    if (workers != NULL) {
+        for (size_t i = 0; i < threads_num; ++i) {
+            free(workers[i].model);
+        }
+    }
+    free(workers);
+    return result;
+}
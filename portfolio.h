@@ -0,0 +1,11 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include "cnf.h"
+#include "dpll.h"
+
+/**
+ * Runs threads_num differently configured searches over the shared CNF in parallel. The first search,
+ * which finds the answer, cancels the others. Its stats and model (see dpll_check_sat) are returned.
+ */
+DpllResult portfolio_check_sat(const CNF* cnf, const DpllOptions* options, size_t threads_num, DpllStats* stats, bool* model);
@@ -0,0 +1,866 @@
+#define  _GNU_SOURCE
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "debug.h"
+#include "preprocess.h"
+
+#define PREPROCESS_ERROR(msg) do { \
+    fprintf(stderr, "Preprocess Error: " msg "\n"); \
+} while (0)
+
+#define TIME_CHECK_INTERVAL 64 // Number of clauses or vars processed between checks of the time limit
+
+typedef struct WorkClause {
+    size_t offset;      // Index of the first var of the clause in preprocessor vars arena
+    size_t len;
+    uint64_t signature; // Bit (var % 64) is set for every var of the clause regardless of its sign
+    bool deleted;
+} WorkClause;
+
+typedef struct OccList {
+    size_t len;
+    size_t capacity;
+    size_t* clauses;
+} OccList;
+
+typedef struct Preprocessor {
+    size_t vars_num;
+    WorkClause* clauses;
+    size_t clauses_num;
+    size_t clauses_capacity;
+    signed int* vars;          // Vars of all clauses (including deleted ones), strengthened clauses shrink in place
+    size_t vars_len;
+    size_t vars_capacity;
+    OccList* occurances;       // Numbers of not deleted clauses by literal index (see cnf_lit_index)
+    bool* marks;               // Marked literals by literal index, all false between operations
+    signed int* resolvent;     // Buffer for a single clause (at most vars_num vars)
+    size_t* snapshot;          // Buffer for clause numbers, which are about to be deleted
+    size_t snapshot_capacity;
+    ModelStack* stack;
+    PreprocessStats* stats;
+    Proof* proof;              // Resolvents, strengthened and deleted clauses are written to it (may be NULL)
+    bool is_unsat;             // Empty clause was derived
+} Preprocessor;
+
+static double elapsed_seconds(const struct timespec* start) {
+    assert(start != NULL);
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) (now.tv_sec - start->tv_sec) + (double) (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static int reserve_array(void** array, size_t* capacity, size_t len, size_t item_size) {
+    assert(array != NULL);
+    assert(capacity != NULL);
+
+    if (len <= *capacity) {
+        return 0;
+    }
+
+    size_t new_capacity = *capacity == 0 ? 16 : *capacity;
+    while (new_capacity < len) {
+        new_capacity *= 2;
+    }
+    void* new_array = realloc(*array, new_capacity * item_size);
+    if (new_array == NULL) {
+        return -1;
+    }
+    *array = new_array;
+    *capacity = new_capacity;
+    return 0;
+}
+
+static inline signed int* clause_vars(const Preprocessor* pp, const WorkClause* clause) {
+    return pp->vars + clause->offset;
+}
+
+static uint64_t clause_signature(const signed int* vars, size_t len) {
+    uint64_t signature = 0;
+    for (size_t i = 0; i < len; ++i) {
+        signed int var = vars[i] > 0 ? vars[i] : -vars[i];
+        signature |= (uint64_t) 1 << (var % 64);
+    }
+    return signature;
+}
+
+static int occ_list_push(OccList* list, size_t clause_num) {
+    assert(list != NULL);
+
+    if (reserve_array((void**) &list->clauses, &list->capacity, list->len + 1, sizeof(size_t)) != 0) {
+        return -1;
+    }
+    list->clauses[list->len++] = clause_num;
+    return 0;
+}
+
+/**
+ * Removes the clause from the list by moving the last clause in its place.
+ */
+static void occ_list_remove(OccList* list, size_t clause_num) {
+    assert(list != NULL);
+
+    for (size_t i = 0; i < list->len; ++i) {
+        if (list->clauses[i] == clause_num) {
+            list->clauses[i] = list->clauses[--list->len];
+            return;
+        }
+    }
+    assertf(false, "Clause %zu is not in the occurance list", clause_num);
+}
+
+/**
+ * Adds clause without duplicate vars. Empty clause makes the whole CNF unsatisfiable.
+ */
+static int add_clause(Preprocessor* pp, const signed int* vars, size_t len) {
+    assert(pp != NULL);
+
+    if (len == 0) {
+        pp->is_unsat = true;
+        return 0;
+    }
+    if (reserve_array((void**) &pp->clauses, &pp->clauses_capacity, pp->clauses_num + 1, sizeof(WorkClause)) != 0
+            || reserve_array((void**) &pp->vars, &pp->vars_capacity, pp->vars_len + len, sizeof(signed int)) != 0) {
+        return -1;
+    }
+
+    size_t clause_num = pp->clauses_num++;
+    WorkClause* clause = &pp->clauses[clause_num];
+    clause->offset = pp->vars_len;
+    clause->len = len;
+    clause->signature = clause_signature(vars, len);
+    clause->deleted = false;
+    memcpy(pp->vars + pp->vars_len, vars, len * sizeof(signed int));
+    pp->vars_len += len;
+
+    for (size_t i = 0; i < len; ++i) {
+        if (occ_list_push(&pp->occurances[cnf_lit_index(vars[i])], clause_num) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void delete_clause(Preprocessor* pp, size_t clause_num) {
+    assert(pp != NULL);
+
+    WorkClause* clause = &pp->clauses[clause_num];
+    assert(!clause->deleted);
+    const signed int* vars = clause_vars(pp, clause);
+    if (pp->proof != NULL) {
+        proof_delete(pp->proof, vars, clause->len);
+    }
+    for (size_t i = 0; i < clause->len; ++i) {
+        occ_list_remove(&pp->occurances[cnf_lit_index(vars[i])], clause_num);
+    }
+    clause->deleted = true;
+}
+
+static void remove_clause_var(Preprocessor* pp, size_t clause_num, signed int var) {
+    assert(pp != NULL);
+
+    WorkClause* clause = &pp->clauses[clause_num];
+    signed int* vars = clause_vars(pp, clause);
+    size_t old_len = clause->len;
+    if (pp->proof != NULL) {
+        // Strengthened clause is added to the proof before the original one is deleted, which is kept in the buffer
+        memcpy(pp->resolvent, vars, old_len * sizeof(signed int));
+    }
+    for (size_t i = 0; i < clause->len; ++i) {
+        if (vars[i] == var) {
+            vars[i] = vars[--clause->len];
+            break;
+        }
+    }
+    if (pp->proof != NULL) {
+        proof_add(pp->proof, vars, clause->len);
+        proof_delete(pp->proof, pp->resolvent, old_len);
+    }
+    occ_list_remove(&pp->occurances[cnf_lit_index(var)], clause_num);
+    clause->signature = clause_signature(vars, clause->len);
+    if (clause->len == 0) {
+        pp->is_unsat = true;
+    }
+}
+
+static void set_marks(Preprocessor* pp, const WorkClause* clause, bool value) {
+    assert(pp != NULL);
+    assert(clause != NULL);
+
+    const signed int* vars = clause_vars(pp, clause);
+    for (size_t i = 0; i < clause->len; ++i) {
+        pp->marks[cnf_lit_index(vars[i])] = value;
+    }
+}
+
+/**
+ * Checks, that the other clause contains as many marked literals as the clause has vars.
+ */
+static bool contains_marked(const Preprocessor* pp, const WorkClause* clause, size_t other_num) {
+    assert(pp != NULL);
+    assert(clause != NULL);
+
+    const WorkClause* other = &pp->clauses[other_num];
+    if (other->len < clause->len || (clause->signature & ~other->signature) != 0) {
+        return false;
+    }
+
+    size_t marked_num = 0;
+    const signed int* vars = clause_vars(pp, other);
+    for (size_t i = 0; i < other->len; ++i) {
+        if (pp->marks[cnf_lit_index(vars[i])]) {
+            ++marked_num;
+        }
+    }
+    return marked_num == clause->len;
+}
+
+/**
+ * Deletes clauses, that contain all vars of some other clause.
+ */
+static void subsume_clauses(Preprocessor* pp, double time_limit) {
+    assert(pp != NULL);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t clause_num = 0; clause_num < pp->clauses_num; ++clause_num) {
+        if (clause_num % TIME_CHECK_INTERVAL == 0 && elapsed_seconds(&start) > time_limit) {
+            break;
+        }
+        const WorkClause* clause = &pp->clauses[clause_num];
+        if (clause->deleted) {
+            continue;
+        }
+
+        // Every clause subsumed by this one is in the occurance list of each of its vars, so take the shortest
+        const signed int* vars = clause_vars(pp, clause);
+        OccList* list = &pp->occurances[cnf_lit_index(vars[0])];
+        for (size_t i = 1; i < clause->len; ++i) {
+            OccList* candidate = &pp->occurances[cnf_lit_index(vars[i])];
+            if (candidate->len < list->len) {
+                list = candidate;
+            }
+        }
+
+        set_marks(pp, clause, true);
+        for (size_t i = 0; i < list->len;) {
+            size_t other_num = list->clauses[i];
+            if (other_num != clause_num && contains_marked(pp, clause, other_num)) {
+                // The last clause of the list takes place of the deleted one
+                delete_clause(pp, other_num);
+                ++pp->stats->subsumed_clauses;
+            } else {
+                ++i;
+            }
+        }
+        set_marks(pp, clause, false);
+    }
+    pp->stats->subsumption_time = elapsed_seconds(&start);
+}
+
+/**
+ * Self-subsuming resolution: if clause (C, x) and clause (D, -x) are such that C is a subset of D,
+ * then their resolvent D subsumes (D, -x), so -x is removed from it.
+ */
+static void strengthen_clauses(Preprocessor* pp, double time_limit) {
+    assert(pp != NULL);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t clause_num = 0; clause_num < pp->clauses_num && !pp->is_unsat; ++clause_num) {
+        if (clause_num % TIME_CHECK_INTERVAL == 0 && elapsed_seconds(&start) > time_limit) {
+            break;
+        }
+        const WorkClause* clause = &pp->clauses[clause_num];
+        if (clause->deleted) {
+            continue;
+        }
+
+        const signed int* vars = clause_vars(pp, clause);
+        set_marks(pp, clause, true);
+        for (size_t var_num = 0; var_num < clause->len && !pp->is_unsat; ++var_num) {
+            signed int var = vars[var_num];
+            pp->marks[cnf_lit_index(var)] = false;
+            pp->marks[cnf_lit_index(-var)] = true;
+
+            OccList* list = &pp->occurances[cnf_lit_index(-var)];
+            for (size_t i = 0; i < list->len && !pp->is_unsat;) {
+                size_t other_num = list->clauses[i];
+                if (contains_marked(pp, clause, other_num)) {
+                    // The strengthened clause leaves the list, and the last one takes its place
+                    remove_clause_var(pp, other_num, -var);
+                    ++pp->stats->strengthened_clauses;
+                } else {
+                    ++i;
+                }
+            }
+
+            pp->marks[cnf_lit_index(-var)] = false;
+            pp->marks[cnf_lit_index(var)] = true;
+        }
+        set_marks(pp, clause, false);
+    }
+    pp->stats->strengthening_time = elapsed_seconds(&start);
+}
+
+/**
+ * Stores the resolvent of two clauses on the var in the resolvent buffer.
+ * Returns false, if the resolvent is a tautology.
+ */
+static bool resolve(Preprocessor* pp, size_t pos_num, size_t neg_num, signed int var, size_t* len) {
+    assert(pp != NULL);
+    assert(len != NULL);
+    assert(var > 0);
+
+    const WorkClause* pos = &pp->clauses[pos_num];
+    const WorkClause* neg = &pp->clauses[neg_num];
+    const signed int* pos_vars = clause_vars(pp, pos);
+    const signed int* neg_vars = clause_vars(pp, neg);
+
+    *len = 0;
+    for (size_t i = 0; i < pos->len; ++i) {
+        if (pos_vars[i] != var) {
+            pp->marks[cnf_lit_index(pos_vars[i])] = true;
+            pp->resolvent[(*len)++] = pos_vars[i];
+        }
+    }
+    bool is_tautology = false;
+    for (size_t i = 0; i < neg->len && !is_tautology; ++i) {
+        signed int neg_var = neg_vars[i];
+        if (neg_var == -var || pp->marks[cnf_lit_index(neg_var)]) {
+            continue;
+        }
+        if (pp->marks[cnf_lit_index(-neg_var)]) {
+            is_tautology = true;
+        } else {
+            pp->resolvent[(*len)++] = neg_var;
+        }
+    }
+    for (size_t i = 0; i < pos->len; ++i) {
+        pp->marks[cnf_lit_index(pos_vars[i])] = false;
+    }
+    return !is_tautology;
+}
+
+static int push_eliminated_clause(ModelStack* stack, const signed int* vars, size_t len, signed int var) {
+    assert(stack != NULL);
+
+    if (reserve_array((void**) &stack->vars, &stack->capacity, stack->len + len + 1, sizeof(signed int)) != 0) {
+        return -1;
+    }
+    signed int* dest = stack->vars + stack->len;
+    dest[0] = var;
+    size_t dest_len = 1;
+    for (size_t i = 0; i < len; ++i) {
+        if (vars[i] != var) {
+            dest[dest_len++] = vars[i];
+        }
+    }
+    dest[dest_len] = (signed int) dest_len;
+    stack->len += dest_len + 1;
+    return 0;
+}
+
+/**
+ * Bounded variable elimination: replaces all clauses with a var by their non-tautological resolvents on it,
+ * if there are no more resolvents than such clauses.
+ */
+static int eliminate_vars(Preprocessor* pp, double time_limit, size_t resolutions_limit) {
+    assert(pp != NULL);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (signed int var = 1; (size_t) var <= pp->vars_num && !pp->is_unsat; ++var) {
+        if (var % TIME_CHECK_INTERVAL == 0 && elapsed_seconds(&start) > time_limit) {
+            break;
+        }
+        OccList* pos = &pp->occurances[cnf_lit_index(var)];
+        OccList* neg = &pp->occurances[cnf_lit_index(-var)];
+        size_t clauses_num = pos->len + neg->len;
+        if (clauses_num == 0 || pos->len * neg->len > resolutions_limit) {
+            continue;
+        }
+
+        size_t resolvents_num = 0;
+        for (size_t i = 0; i < pos->len && resolvents_num <= clauses_num; ++i) {
+            for (size_t j = 0; j < neg->len && resolvents_num <= clauses_num; ++j) {
+                size_t len = 0;
+                if (resolve(pp, pos->clauses[i], neg->clauses[j], var, &len)) {
+                    ++resolvents_num;
+                }
+            }
+        }
+        if (resolvents_num > clauses_num) {
+            continue;
+        }
+
+        if (reserve_array((void**) &pp->snapshot, &pp->snapshot_capacity, clauses_num, sizeof(size_t)) != 0) {
+            return -1;
+        }
+        size_t pos_len = pos->len;
+        for (size_t i = 0; i < clauses_num; ++i) {
+            pp->snapshot[i] = i < pos_len ? pos->clauses[i] : neg->clauses[i - pos_len];
+        }
+        // Resolvents are added before their antecedents are deleted, so each of them is implied by clauses of the proof.
+        // They do not contain the var, so its occurance lists are left intact
+        for (size_t i = 0; i < pos_len && !pp->is_unsat; ++i) {
+            for (size_t j = pos_len; j < clauses_num && !pp->is_unsat; ++j) {
+                size_t len = 0;
+                if (!resolve(pp, pp->snapshot[i], pp->snapshot[j], var, &len)) {
+                    continue;
+                }
+                if (pp->proof != NULL) {
+                    proof_add(pp->proof, pp->resolvent, len);
+                }
+                if (add_clause(pp, pp->resolvent, len) != 0) {
+                    return -1;
+                }
+            }
+        }
+        for (size_t i = 0; i < clauses_num; ++i) {
+            const WorkClause* clause = &pp->clauses[pp->snapshot[i]];
+            if (push_eliminated_clause(pp->stack, clause_vars(pp, clause), clause->len, i < pos_len ? var : -var) != 0) {
+                return -1;
+            }
+            delete_clause(pp, pp->snapshot[i]);
+        }
+        ++pp->stats->eliminated_vars;
+    }
+    pp->stats->elimination_time = elapsed_seconds(&start);
+    return 0;
+}
+
+static inline signed int lit_of_index(size_t lit_index) {
+    signed int var = (signed int) (lit_index / 2) + 1;
+    return lit_index % 2 == 0 ? var : -var;
+}
+
+/**
+ * Tarjan's strongly connected components of the binary implication graph, where clause (a, b) gives edges
+ * -a -> b and -b -> a. Literals of a component are equivalent, and components come out in reverse topological
+ * order, so the complement of a component is either found before it or right after it. Each literal gets
+ * representative of its component in repr (its var is the lowest one, or the complement of the representative
+ * of the complementary component). Returns 1, if a literal and its negation share a component, which is stored
+ * in conflict_var, or -1, if out of memory.
+ */
+static int find_equivalent_lits(Preprocessor* pp, signed int* repr, signed int* conflict_var) {
+    assert(pp != NULL);
+    assert(repr != NULL);
+    assert(conflict_var != NULL);
+
+    size_t lits_num = 2 * pp->vars_num;
+    size_t* order = (size_t*) calloc(lits_num, sizeof(size_t)); // Discovery order from 1, 0 for unvisited literals
+    size_t* low = (size_t*) calloc(lits_num, sizeof(size_t));
+    size_t* component = (size_t*) malloc(lits_num * sizeof(size_t)); // Visited literals, which have no component yet
+    size_t* path = (size_t*) malloc(lits_num * sizeof(size_t));      // Literals of the depth-first search path
+    size_t* next_edge = (size_t*) calloc(lits_num, sizeof(size_t));  // Position in occurance list of the negation
+    bool* on_component = (bool*) calloc(lits_num, sizeof(bool));
+    int status = 0;
+    if (lits_num > 0 && (order == NULL || low == NULL || component == NULL || path == NULL || next_edge == NULL
+            || on_component == NULL)) {
+        status = -1;
+        goto exit;
+    }
+
+    size_t visited_num = 0;
+    size_t component_len = 0;
+    for (size_t root = 0; root < lits_num && status == 0; ++root) {
+        if (order[root] != 0) {
+            continue;
+        }
+        size_t path_len = 0;
+        path[path_len++] = root;
+        order[root] = low[root] = ++visited_num;
+        component[component_len++] = root;
+        on_component[root] = true;
+        while (path_len > 0 && status == 0) {
+            size_t lit_index = path[path_len - 1];
+            signed int negation = -lit_of_index(lit_index);
+            const OccList* list = &pp->occurances[cnf_lit_index(negation)];
+            if (next_edge[lit_index] < list->len) {
+                const WorkClause* clause = &pp->clauses[list->clauses[next_edge[lit_index]++]];
+                if (clause->len != 2) {
+                    continue;
+                }
+                const signed int* vars = clause_vars(pp, clause);
+                size_t next = cnf_lit_index(vars[0] == negation ? vars[1] : vars[0]);
+                if (order[next] == 0) {
+                    path[path_len++] = next;
+                    order[next] = low[next] = ++visited_num;
+                    component[component_len++] = next;
+                    on_component[next] = true;
+                } else if (on_component[next] && order[next] < low[lit_index]) {
+                    low[lit_index] = order[next];
+                }
+                continue;
+            }
+
+            --path_len;
+            if (path_len > 0 && low[lit_index] < low[path[path_len - 1]]) {
+                low[path[path_len - 1]] = low[lit_index];
+            }
+            if (low[lit_index] != order[lit_index]) {
+                continue;
+            }
+            // Literal is the root of a component, which takes the rest of the component stack from it
+            size_t start = component_len;
+            do {
+                on_component[component[--start]] = false;
+            } while (component[start] != lit_index);
+            signed int complement_repr = repr[component[start] ^ 1];
+            signed int representative = lit_of_index(component[start]);
+            if (complement_repr != 0) {
+                representative = -complement_repr;
+            } else {
+                for (size_t i = start; i < component_len; ++i) {
+                    if (component[i] / 2 < cnf_lit_index(representative) / 2) {
+                        representative = lit_of_index(component[i]);
+                    }
+                }
+            }
+            for (size_t i = start; i < component_len; ++i) {
+                repr[component[i]] = representative;
+            }
+            for (size_t i = start; i < component_len && status == 0; ++i) {
+                if (repr[component[i] ^ 1] == representative) {
+                    *conflict_var = lit_of_index(component[i]);
+                    status = 1;
+                }
+            }
+            component_len = start;
+        }
+    }
+
+exit:
+    free(order);
+    free(low);
+    free(component);
+    free(path);
+    free(next_edge);
+    free(on_component);
+    return status;
+}
+
+/**
+ * Adds both implications between the literal and its representative to the proof, or deletes them.
+ * Each of them follows from the path of binary clauses between the two, and rewritten clauses follow from them.
+ */
+static void write_equivalence(Preprocessor* pp, signed int var, signed int representative, bool is_deletion) {
+    assert(pp != NULL);
+
+    signed int first[2] = {-var, representative};
+    signed int second[2] = {var, -representative};
+    if (is_deletion) {
+        proof_delete(pp->proof, first, 2);
+        proof_delete(pp->proof, second, 2);
+    } else {
+        proof_add(pp->proof, first, 2);
+        proof_add(pp->proof, second, 2);
+    }
+}
+
+/**
+ * Equivalent literal substitution: replaces each var, that is equivalent to some literal by a cycle of
+ * binary implications, with the representative of its class in every clause. Rewritten clauses may have
+ * duplicate vars, which are merged, or become tautologies, which are deleted. Var gets the value of its
+ * representative back from the two implications between them, which are pushed to the model stack.
+ */
+static int substitute_equivalent_vars(Preprocessor* pp) {
+    assert(pp != NULL);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    signed int* repr = (signed int*) calloc(2 * pp->vars_num + 1, sizeof(signed int));
+    if (repr == NULL) {
+        return -1;
+    }
+    signed int conflict_var = 0;
+    int status = find_equivalent_lits(pp, repr, &conflict_var);
+    if (status == 1) {
+        // The literal implies its negation, so its negation is a unit, which implies the literal in turn
+        if (pp->proof != NULL) {
+            signed int unit = -conflict_var;
+            proof_add(pp->proof, &unit, 1);
+        }
+        pp->is_unsat = true;
+        status = 0;
+        goto exit;
+    }
+    if (status != 0) {
+        goto exit;
+    }
+
+    // Equivalences are added before any clause is rewritten, as rewriting deletes the paths, they follow from
+    for (signed int var = 1; pp->proof != NULL && (size_t) var <= pp->vars_num; ++var) {
+        if (repr[cnf_lit_index(var)] != var) {
+            write_equivalence(pp, var, repr[cnf_lit_index(var)], false);
+        }
+    }
+    for (signed int var = 1; (size_t) var <= pp->vars_num && status == 0; ++var) {
+        signed int representative = repr[cnf_lit_index(var)];
+        if (representative == var) {
+            continue;
+        }
+        OccList* pos = &pp->occurances[cnf_lit_index(var)];
+        OccList* neg = &pp->occurances[cnf_lit_index(-var)];
+        size_t clauses_num = pos->len + neg->len;
+        if (reserve_array((void**) &pp->snapshot, &pp->snapshot_capacity, clauses_num, sizeof(size_t)) != 0) {
+            status = -1;
+            break;
+        }
+        size_t pos_len = pos->len;
+        for (size_t i = 0; i < clauses_num; ++i) {
+            pp->snapshot[i] = i < pos_len ? pos->clauses[i] : neg->clauses[i - pos_len];
+        }
+        for (size_t i = 0; i < clauses_num && status == 0; ++i) {
+            // Every literal is replaced at once, so the clause is rewritten once for all of its substituted vars
+            const WorkClause* clause = &pp->clauses[pp->snapshot[i]];
+            const signed int* vars = clause_vars(pp, clause);
+            size_t len = 0;
+            bool is_tautology = false;
+            for (size_t j = 0; j < clause->len && !is_tautology; ++j) {
+                signed int lit = repr[cnf_lit_index(vars[j])];
+                if (pp->marks[cnf_lit_index(-lit)]) {
+                    is_tautology = true;
+                } else if (!pp->marks[cnf_lit_index(lit)]) {
+                    pp->marks[cnf_lit_index(lit)] = true;
+                    pp->resolvent[len++] = lit;
+                }
+            }
+            for (size_t j = 0; j < len; ++j) {
+                pp->marks[cnf_lit_index(pp->resolvent[j])] = false;
+            }
+            if (!is_tautology) {
+                if (pp->proof != NULL) {
+                    proof_add(pp->proof, pp->resolvent, len);
+                }
+                status = add_clause(pp, pp->resolvent, len);
+            }
+            if (status == 0) {
+                delete_clause(pp, pp->snapshot[i]);
+            }
+        }
+        signed int first[2] = {var, -representative};
+        signed int second[2] = {-var, representative};
+        if (status == 0 && (push_eliminated_clause(pp->stack, first, 2, var) != 0
+                || push_eliminated_clause(pp->stack, second, 2, -var) != 0)) {
+            status = -1;
+        }
+        ++pp->stats->substituted_vars;
+    }
+    for (signed int var = 1; pp->proof != NULL && status == 0 && (size_t) var <= pp->vars_num; ++var) {
+        if (repr[cnf_lit_index(var)] != var) {
+            write_equivalence(pp, var, repr[cnf_lit_index(var)], true);
+        }
+    }
+
+exit:
+    free(repr);
+    pp->stats->substitution_time = elapsed_seconds(&start);
+    return status;
+}
+
+static size_t count_occuring_vars(const Preprocessor* pp) {
+    assert(pp != NULL);
+
+    size_t vars_num = 0;
+    for (size_t i = 0; i < pp->vars_num; ++i) {
+        if (pp->occurances[2 * i].len + pp->occurances[2 * i + 1].len > 0) {
+            ++vars_num;
+        }
+    }
+    return vars_num;
+}
+
+/**
+ * Copies clauses of the CNF without duplicate vars and tautologies.
+ */
+static int load_cnf(Preprocessor* pp, const CNF* cnf) {
+    assert(pp != NULL);
+    assert(cnf != NULL);
+
+    for (size_t clause_num = 0; clause_num < cnf->clauses_num; ++clause_num) {
+        const Clause* clause = &cnf->clauses[clause_num];
+        const signed int* vars = cnf_clause_vars(cnf, clause);
+        size_t len = 0;
+        bool is_tautology = false;
+        for (size_t i = 0; i < clause->len; ++i) {
+            signed int var = vars[i];
+            if (pp->marks[cnf_lit_index(-var)]) {
+                is_tautology = true;
+            } else if (!pp->marks[cnf_lit_index(var)]) {
+                pp->marks[cnf_lit_index(var)] = true;
+                pp->resolvent[len++] = var;
+            }
+        }
+        for (size_t i = 0; i < clause->len; ++i) {
+            pp->marks[cnf_lit_index(vars[i])] = false;
+        }
+        if (!is_tautology && add_clause(pp, pp->resolvent, len) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static CNF* build_cnf(const Preprocessor* pp) {
+    assert(pp != NULL);
+
+    if (pp->is_unsat) {
+        CNF* cnf = create_cnf(pp->vars_num, 1, 0);
+        if (cnf == NULL || cnf_add_clause(cnf, NULL, 0) != 0) {
+            free_cnf(cnf);
+            return NULL;
+        }
+        return cnf;
+    }
+
+    size_t clauses_num = 0;
+    size_t vars_len = 0;
+    for (size_t i = 0; i < pp->clauses_num; ++i) {
+        if (!pp->clauses[i].deleted) {
+            ++clauses_num;
+            vars_len += pp->clauses[i].len;
+        }
+    }
+    CNF* cnf = create_cnf(pp->vars_num, clauses_num, vars_len);
+    if (cnf == NULL) {
+        return NULL;
+    }
+    for (size_t i = 0; i < pp->clauses_num; ++i) {
+        const WorkClause* clause = &pp->clauses[i];
+        if (!clause->deleted && cnf_add_clause(cnf, clause_vars(pp, clause), clause->len) != 0) {
+            free_cnf(cnf);
+            return NULL;
+        }
+    }
+    return cnf;
+}
+
+static void free_preprocessor(Preprocessor* pp) {
+    if (pp != NULL) {
+        if (pp->occurances != NULL) {
+            for (size_t i = 0; i < 2 * pp->vars_num; ++i) {
+                free(pp->occurances[i].clauses);
+            }
+        }
+        free(pp->occurances);
+        free(pp->clauses);
+        free(pp->vars);
+        free(pp->marks);
+        free(pp->resolvent);
+        free(pp->snapshot);
+        free(pp);
+    }
+}
+
+static Preprocessor* create_preprocessor(size_t vars_num, ModelStack* stack, PreprocessStats* stats, Proof* proof) {
+    Preprocessor* pp = (Preprocessor*) calloc(1, sizeof(Preprocessor));
+    if (pp == NULL) {
+        return NULL;
+    }
+    pp->vars_num = vars_num;
+    pp->stack = stack;
+    pp->stats = stats;
+    pp->proof = proof;
+    pp->occurances = (OccList*) calloc(2 * vars_num + 1, sizeof(OccList));
+    pp->marks = (bool*) calloc(2 * vars_num + 1, sizeof(bool));
+    pp->resolvent = (signed int*) calloc(vars_num + 1, sizeof(signed int));
+    if (pp->occurances == NULL || pp->marks == NULL || pp->resolvent == NULL) {
+        free_preprocessor(pp);
+        return NULL;
+    }
+    return pp;
+}
+
+PreprocessOptions preprocess_default_options(void) {
+    PreprocessOptions options = {
+        .subsumption_time_limit = 1.0,
+        .strengthening_time_limit = 1.0,
+        .elimination_time_limit = 1.0,
+        .elimination_resolutions_limit = 256,
+        .proof = NULL,
+    };
+    return options;
+}
+
+ModelStack* create_model_stack(void) {
+    return (ModelStack*) calloc(1, sizeof(ModelStack));
+}
+
+void free_model_stack(ModelStack* stack) {
+    if (stack != NULL) {
+        free(stack->vars);
+        free(stack);
+    }
+}
+
+CNF* preprocess_cnf(const CNF* cnf, const PreprocessOptions* options, ModelStack* stack, PreprocessStats* stats) {
+    assert(cnf != NULL);
+    assert(options != NULL);
+    assert(stack != NULL);
+    assert(stats != NULL);
+
+    CNF* result = NULL;
+    *stats = (PreprocessStats) {0};
+    Preprocessor* pp = create_preprocessor(cnf->vars_num, stack, stats, options->proof);
+    if (pp == NULL || load_cnf(pp, cnf) != 0) {
+        PREPROCESS_ERROR("Insufficient memory");
+        goto exit;
+    }
+    stats->clauses_before = cnf->clauses_num;
+    stats->vars_before = count_occuring_vars(pp);
+
+    if (substitute_equivalent_vars(pp) != 0) {
+        PREPROCESS_ERROR("Insufficient memory");
+        goto exit;
+    }
+    if (!pp->is_unsat) {
+        subsume_clauses(pp, options->subsumption_time_limit);
+    }
+    if (!pp->is_unsat) {
+        strengthen_clauses(pp, options->strengthening_time_limit);
+    }
+    if (!pp->is_unsat && eliminate_vars(pp, options->elimination_time_limit, options->elimination_resolutions_limit) != 0) {
+        PREPROCESS_ERROR("Insufficient memory");
+        goto exit;
+    }
+
+    result = build_cnf(pp);
+    if (result == NULL) {
+        PREPROCESS_ERROR("Insufficient memory");
+        goto exit;
+    }
+    stats->vars_after = pp->is_unsat ? 0 : count_occuring_vars(pp);
+    stats->clauses_after = result->clauses_num;
+
+exit:
+    free_preprocessor(pp);
+    return result;
+}
+
+void reconstruct_model(const ModelStack* stack, bool* model) {
+    assert(stack != NULL);
+    assert(model != NULL);
+
+    // Clauses are checked in reverse order of elimination, so later eliminated vars are fixed first
+    size_t end = stack->len;
+    while (end > 0) {
+        size_t len = (size_t) stack->vars[end - 1];
+        const signed int* vars = stack->vars + end - 1 - len;
+        bool is_satisfied = false;
+        for (size_t i = 0; i < len && !is_satisfied; ++i) {
+            signed int var = vars[i];
+            is_satisfied = model[(var > 0 ? var : -var) - 1] == (var > 0);
+        }
+        if (!is_satisfied) {
+            signed int var = vars[0];
+            model[(var > 0 ? var : -var) - 1] = var > 0;
+        }
+        end -= len + 1;
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include "cnf.h"
+#include "proof.h"
+
+typedef struct PreprocessOptions {
+    double subsumption_time_limit;   // Seconds, each step stops after its own limit is exceeded
+    double strengthening_time_limit;
+    double elimination_time_limit;
+    size_t elimination_resolutions_limit; // Vars with more pairs of clauses to resolve are never eliminated
+    Proof* proof;                         // Clauses derived and deleted by preprocessing are written to it (may be NULL)
+} PreprocessOptions;
+
+typedef struct PreprocessStats {
+    size_t vars_before;  // Vars, that occur in clauses
+    size_t vars_after;
+    size_t clauses_before;
+    size_t clauses_after;
+    size_t substituted_vars; // Vars replaced by an equivalent literal
+    size_t subsumed_clauses;
+    size_t strengthened_clauses;
+    size_t eliminated_vars;
+    double substitution_time; // Seconds
+    double subsumption_time;
+    double strengthening_time;
+    double elimination_time;
+} PreprocessStats;
+
+/**
+ * Clauses removed by var elimination and implications between substituted vars and their representatives,
+ * which are needed to extend a model of the preprocessed CNF. Each clause is stored as its vars (the first one
+ * is the eliminated literal) followed by its length.
+ */
+typedef struct ModelStack {
+    signed int* vars;
+    size_t len;
+    size_t capacity;
+} ModelStack;
+
+PreprocessOptions preprocess_default_options(void);
+
+ModelStack* create_model_stack(void);
+
+void free_model_stack(ModelStack* stack);
+
+/**
+ * Returns CNF over the same vars, that is satisfiable iff the given one is. Clauses, needed to rebuild
+ * a model of the given CNF from a model of the returned one, are pushed to the stack.
+ */
+CNF* preprocess_cnf(const CNF* cnf, const PreprocessOptions* options, ModelStack* stack, PreprocessStats* stats);
+
+/**
+ * Turns a model of the preprocessed CNF into a model of the original one (value of var i is model[i - 1]).
+ */
+void reconstruct_model(const ModelStack* stack, bool* model);
@@ -0,0 +1,125 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "proof.h"
+
+#define PROOF_ERROR(msg) do { \
+    fprintf(stderr, "Proof Error: " msg "\n"); \
+} while (0)
+
+#define PROOF_MAX_ITEM_LEN 12 // Bytes of the longest literal ("-2147483648 "), lemma prefix or terminator
+
+static void flush_buffer(Proof* proof) {
+    assert(proof != NULL);
+
+    if (!proof->has_error && fwrite(proof->buffer, 1, proof->len, proof->fp) != proof->len) {
+        PROOF_ERROR("Failed to write proof");
+        proof->has_error = true;
+    }
+    proof->len = 0;
+}
+
+/**
+ * Makes room for one more item, so lemmas of any length are written without checks per byte.
+ */
+static inline void reserve_item(Proof* proof) {
+    if (proof->len + PROOF_MAX_ITEM_LEN > PROOF_BUFFER_SIZE) {
+        flush_buffer(proof);
+    }
+}
+
+static inline void write_binary_var(Proof* proof, signed int var) {
+    unsigned int value = 2 * (var > 0 ? (unsigned int) var : -(unsigned int) var) + (var < 0);
+    while (value > 0x7F) {
+        proof->buffer[proof->len++] = (unsigned char) (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    proof->buffer[proof->len++] = (unsigned char) value;
+}
+
+static inline void write_text_var(Proof* proof, signed int var) {
+    char digits[PROOF_MAX_ITEM_LEN];
+    size_t digits_num = 0;
+    unsigned int value = var > 0 ? (unsigned int) var : -(unsigned int) var;
+    do {
+        digits[digits_num++] = (char) ('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    if (var < 0) {
+        proof->buffer[proof->len++] = '-';
+    }
+    while (digits_num > 0) {
+        proof->buffer[proof->len++] = (unsigned char) digits[--digits_num];
+    }
+    proof->buffer[proof->len++] = ' ';
+}
+
+static void write_lemma(Proof* proof, const signed int* vars, size_t len, bool is_deletion) {
+    assert(proof != NULL);
+    assert(vars != NULL || len == 0);
+
+    reserve_item(proof);
+    if (proof->format == PROOF_BINARY) {
+        proof->buffer[proof->len++] = is_deletion ? 'd' : 'a';
+        for (size_t i = 0; i < len; ++i) {
+            reserve_item(proof);
+            write_binary_var(proof, vars[i]);
+        }
+        reserve_item(proof);
+        proof->buffer[proof->len++] = 0;
+    } else {
+        if (is_deletion) {
+            proof->buffer[proof->len++] = 'd';
+            proof->buffer[proof->len++] = ' ';
+        }
+        for (size_t i = 0; i < len; ++i) {
+            reserve_item(proof);
+            write_text_var(proof, vars[i]);
+        }
+        reserve_item(proof);
+        proof->buffer[proof->len++] = '0';
+        proof->buffer[proof->len++] = '\n';
+    }
+}
+
+Proof* create_proof(FILE* fp, ProofFormat format) {
+    assert(fp != NULL);
+
+    Proof* proof = (Proof*) calloc(1, sizeof(Proof));
+    if (proof == NULL) {
+        PROOF_ERROR("Insufficient memory");
+        return NULL;
+    }
+    proof->fp = fp;
+    proof->format = format;
+    proof->buffer = (unsigned char*) malloc(PROOF_BUFFER_SIZE);
+    if (proof->buffer == NULL) {
+        PROOF_ERROR("Insufficient memory");
+        free(proof);
+        return NULL;
+    }
+    return proof;
+}
+
+int close_proof(Proof* proof) {
+    if (proof == NULL) {
+        return 0;
+    }
+    flush_buffer(proof);
+    bool has_error = proof->has_error;
+    if (fclose(proof->fp) != 0) {
+        PROOF_ERROR("Failed to write proof");
+        has_error = true;
+    }
+    free(proof->buffer);
+    free(proof);
+    return has_error ? -1 : 0;
+}
+
+void proof_add(Proof* proof, const signed int* vars, size_t len) {
+    write_lemma(proof, vars, len, false);
+}
+
+void proof_delete(Proof* proof, const signed int* vars, size_t len) {
+    write_lemma(proof, vars, len, true);
+}
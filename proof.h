@@ -0,0 +1,37 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#define PROOF_BUFFER_SIZE (1 << 20) // Bytes of lemmas collected before they are written to the file at once
+
+typedef enum {
+    PROOF_BINARY, // Literal l is a variable-length number 2 * |l| + (l < 0), 'a' or 'd' starts each lemma
+    PROOF_TEXT,   // Lemmas are DIMACS clauses, deletions are prefixed with "d "
+} ProofFormat;
+
+/**
+ * DRAT proof: clauses, that are implied by the current ones (added lemmas), and clauses, that are
+ * no longer used (deletions). Unsatisfiability is proved once the empty clause is added.
+ */
+typedef struct Proof {
+    FILE* fp;
+    ProofFormat format;
+    unsigned char* buffer;
+    size_t len;
+    bool has_error; // Writing failed, so the rest of the proof is dropped
+} Proof;
+
+/**
+ * Creates a proof written to the file, which is closed by close_proof. Returns NULL if out of memory.
+ */
+Proof* create_proof(FILE* fp, ProofFormat format);
+
+/**
+ * Writes the rest of the proof, closes its file and frees it. Returns -1 if any write failed.
+ */
+int close_proof(Proof* proof);
+
+void proof_add(Proof* proof, const signed int* vars, size_t len);
+
+void proof_delete(Proof* proof, const signed int* vars, size_t len);
@@ -0,0 +1,42 @@
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Preloaded library, that counts calls of malloc, calloc and realloc of the process
+ * and writes their number into the file given by ALLOCATIONS_FILE environment variable at exit.
+ * Usage: LD_PRELOAD=path/to/count-allocations.so ALLOCATIONS_FILE=path/to/file solver ...
+ */
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t items_num, size_t item_size);
+extern void* __libc_realloc(void* pointer, size_t size);
+
+static atomic_size_t allocations_num;
+
+void* malloc(size_t size) {
+    atomic_fetch_add_explicit(&allocations_num, 1, memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t items_num, size_t item_size) {
+    atomic_fetch_add_explicit(&allocations_num, 1, memory_order_relaxed);
+    return __libc_calloc(items_num, item_size);
+}
+
+void* realloc(void* pointer, size_t size) {
+    atomic_fetch_add_explicit(&allocations_num, 1, memory_order_relaxed);
+    return __libc_realloc(pointer, size);
+}
+
+__attribute__((destructor))
+static void write_allocations_num(void) {
+    size_t allocations = atomic_load(&allocations_num);
+    const char* path = getenv("ALLOCATIONS_FILE");
+    FILE* fp = path != NULL ? fopen(path, "w") : NULL;
+    if (fp != NULL) {
+        fprintf(fp, "%zu\n", allocations);
+        fclose(fp);
+    }
+}
@@ -0,0 +1,51 @@
+#!/bin/bash
+
+# Counts allocations of runs, that stop after different numbers of decisions (DPLL) or conflicts (CDCL).
+# Search itself should not allocate, so the extra search of the longer run adds no allocations (DPLL)
+# or only the rare ones of the growing learned clauses storage (CDCL, at most one per 10 conflicts).
+# CNF should not be solved faster than the longest run.
+
+function success() {
+    echo "[ OK ]  ($1)"
+    exit 0
+}
+
+function failure() {
+    echo "[FAIL]: $1 ($2)"
+    exit 1
+}
+
+CNF_FILE=$3
+COUNT_FILE=$(mktemp)
+trap "rm -f $COUNT_FILE" EXIT
+
+function count_allocations() {
+    LD_PRELOAD=$PRELOAD_LIBRARY ALLOCATIONS_FILE=$COUNT_FILE $BINARY "${SOLVER_ARGS[@]}" "$@" $CNF_FILE > /dev/null
+    # Budget should be exhausted (UNKNOWN exits with 2)
+    if [[ $? -ne 2 ]]; then
+        return 1
+    fi
+    cat $COUNT_FILE
+}
+
+BINARY=$1
+PRELOAD_LIBRARY=$(realpath $2)
+SOLVER_ARGS=("${@:4}")
+
+test -e $BINARY || failure "Binary doesn't exist at $BINARY" $3
+test -e $PRELOAD_LIBRARY || failure "Allocations counter doesn't exist at $2" $3
+test -e $CNF_FILE || failure "CNF file doesn't exist at $CNF_FILE" $3
+
+SHORT=$(count_allocations --mode=dpll --max-decisions=1000) || failure "Expected UNKNOWN after 1000 decisions" $3
+LONG=$(count_allocations --mode=dpll --max-decisions=100000) || failure "Expected UNKNOWN after 100000 decisions" $3
+if [[ $LONG -ne $SHORT ]]; then
+    failure "DPLL search allocated $((LONG - SHORT)) times in 99000 decisions" $3
+fi
+
+SHORT=$(count_allocations --mode=cdcl --max-conflicts=2000) || failure "Expected UNKNOWN after 2000 conflicts" $3
+LONG=$(count_allocations --mode=cdcl --max-conflicts=20000) || failure "Expected UNKNOWN after 20000 conflicts" $3
+if [[ $(((LONG - SHORT) * 10)) -gt 18000 ]]; then
+    failure "CDCL search allocated $((LONG - SHORT)) times in 18000 conflicts" $3
+fi
+
+success $3
@@ -2,6 +2,6 @@
 
 cd $(dirname $0)
 for cnf_file in $(find . -name "*.cnf" -type f); do
-    ./run-single-test.sh $1 $cnf_file;
+    ./run-single-test.sh $1 $cnf_file "${@:2}";
 done
 
@@ -0,0 +1,581 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cnf.h"
+
+/**
+ * Forward DRAT checker for proofs written with --proof. Each added lemma should be implied by unit propagation
+ * of the current clauses (RUP) or be a resolution asymmetric tautology on its first literal (RAT), and the proof
+ * should end with the empty clause (or make the current clauses refuted by unit propagation).
+ * Deletions of unit clauses are ignored like drat-trim does. Binary proofs are told from text ones by zero bytes.
+ * Usage: check-drat input.cnf proof.drat
+ */
+
+typedef struct CheckClause {
+    size_t offset; // Index of the first literal of the clause in the literals arena
+    size_t len;
+    uint64_t hash; // Does not depend on the order of literals, so deletions find clauses with literals in any order
+    bool deleted;
+} CheckClause;
+
+typedef struct ClauseNums {
+    size_t* items;
+    size_t len;
+    size_t capacity;
+} ClauseNums;
+
+typedef struct Checker {
+    size_t vars_num;
+    CheckClause* clauses;
+    size_t clauses_num;
+    size_t clauses_capacity;
+    signed int* lits;
+    size_t lits_len;
+    size_t lits_capacity;
+    ClauseNums* watches;  // By literal index, clauses longer than one literal watch their first two literals
+    ClauseNums units;     // Unit clauses are assigned before every check instead of being watched
+    size_t* buckets;      // Hash table of not deleted clauses, chained through next_in_bucket
+    size_t buckets_num;
+    size_t* next_in_bucket;
+    size_t next_in_bucket_capacity;
+    signed char* values;  // By literal index: 1 if the literal is true, -1 if it is false
+    bool* marks;          // By literal index, all false between operations
+    signed int* trail;
+    size_t trail_len;
+    signed int* lemma;    // Lemma being checked, then the resolvent checked for RAT
+    size_t lemma_capacity;
+    size_t lemmas_num;
+    size_t rat_lemmas_num;
+    size_t deletions_num;
+    size_t ignored_deletions_num;
+    bool has_empty_clause;
+} Checker;
+
+#define NO_CLAUSE ((size_t) -1)
+
+static void* checked_realloc(void* array, size_t size) {
+    void* result = realloc(array, size > 0 ? size : 1);
+    if (result == NULL) {
+        fprintf(stderr, "Insufficient memory\n");
+        exit(EXIT_FAILURE);
+    }
+    return result;
+}
+
+static void reserve(void** array, size_t* capacity, size_t len, size_t item_size) {
+    if (len > *capacity) {
+        size_t new_capacity = *capacity == 0 ? 16 : *capacity;
+        while (new_capacity < len) {
+            new_capacity *= 2;
+        }
+        *array = checked_realloc(*array, new_capacity * item_size);
+        *capacity = new_capacity;
+    }
+}
+
+static void clause_nums_push(ClauseNums* nums, size_t clause_num) {
+    reserve((void**) &nums->items, &nums->capacity, nums->len + 1, sizeof(size_t));
+    nums->items[nums->len++] = clause_num;
+}
+
+static uint64_t lit_hash(signed int lit) {
+    // Splitmix64 finalizer
+    uint64_t x = (uint64_t) (int64_t) lit + 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static uint64_t clause_hash(const signed int* lits, size_t len) {
+    uint64_t hash = 0;
+    for (size_t i = 0; i < len; ++i) {
+        hash += lit_hash(lits[i]);
+    }
+    return hash;
+}
+
+/**
+ * Makes literals of vars up to var available, new vars are unassigned.
+ */
+static void grow_vars(Checker* checker, size_t vars_num) {
+    if (vars_num <= checker->vars_num) {
+        return;
+    }
+    size_t lits_num = 2 * vars_num;
+    size_t old_lits_num = 2 * checker->vars_num;
+    checker->watches = (ClauseNums*) checked_realloc(checker->watches, lits_num * sizeof(ClauseNums));
+    checker->values = (signed char*) checked_realloc(checker->values, lits_num * sizeof(signed char));
+    checker->marks = (bool*) checked_realloc(checker->marks, lits_num * sizeof(bool));
+    checker->trail = (signed int*) checked_realloc(checker->trail, vars_num * sizeof(signed int));
+    memset(checker->watches + old_lits_num, 0, (lits_num - old_lits_num) * sizeof(ClauseNums));
+    memset(checker->values + old_lits_num, 0, (lits_num - old_lits_num) * sizeof(signed char));
+    memset(checker->marks + old_lits_num, 0, (lits_num - old_lits_num) * sizeof(bool));
+    checker->vars_num = vars_num;
+}
+
+static inline signed char lit_value(const Checker* checker, signed int lit) {
+    return checker->values[cnf_lit_index(lit)];
+}
+
+static inline void assign(Checker* checker, signed int lit) {
+    checker->values[cnf_lit_index(lit)] = 1;
+    checker->values[cnf_lit_index(-lit)] = -1;
+    checker->trail[checker->trail_len++] = lit;
+}
+
+static void unassign_all(Checker* checker) {
+    for (size_t i = 0; i < checker->trail_len; ++i) {
+        checker->values[cnf_lit_index(checker->trail[i])] = 0;
+        checker->values[cnf_lit_index(-checker->trail[i])] = 0;
+    }
+    checker->trail_len = 0;
+}
+
+/**
+ * Propagates every assigned literal from the start of the trail. Returns true on conflict.
+ */
+static bool propagate(Checker* checker) {
+    for (size_t head = 0; head < checker->trail_len; ++head) {
+        signed int false_lit = -checker->trail[head];
+        ClauseNums* list = &checker->watches[cnf_lit_index(false_lit)];
+        size_t kept = 0;
+        for (size_t i = 0; i < list->len; ++i) {
+            size_t clause_num = list->items[i];
+            const CheckClause* clause = &checker->clauses[clause_num];
+            if (clause->deleted) {
+                continue;
+            }
+            signed int* lits = checker->lits + clause->offset;
+            if (lits[0] == false_lit) {
+                lits[0] = lits[1];
+                lits[1] = false_lit;
+            }
+            if (lit_value(checker, lits[0]) == 1) {
+                list->items[kept++] = clause_num;
+                continue;
+            }
+            bool is_moved = false;
+            for (size_t k = 2; k < clause->len; ++k) {
+                if (lit_value(checker, lits[k]) != -1) {
+                    lits[1] = lits[k];
+                    lits[k] = false_lit;
+                    clause_nums_push(&checker->watches[cnf_lit_index(lits[1])], clause_num);
+                    is_moved = true;
+                    break;
+                }
+            }
+            if (is_moved) {
+                continue;
+            }
+            list->items[kept++] = clause_num;
+            if (lit_value(checker, lits[0]) == -1) {
+                for (++i; i < list->len; ++i) {
+                    list->items[kept++] = list->items[i];
+                }
+                list->len = kept;
+                return true;
+            }
+            assign(checker, lits[0]);
+        }
+        list->len = kept;
+    }
+    return false;
+}
+
+/**
+ * Checks, that assigning unit clauses and negations of the literals leads to a conflict.
+ */
+static bool is_rup(Checker* checker, const signed int* lits, size_t len) {
+    bool has_conflict = false;
+    for (size_t i = 0; i < checker->units.len && !has_conflict; ++i) {
+        signed int unit = checker->lits[checker->clauses[checker->units.items[i]].offset];
+        if (lit_value(checker, unit) == -1) {
+            has_conflict = true;
+        } else if (lit_value(checker, unit) == 0) {
+            assign(checker, unit);
+        }
+    }
+    for (size_t i = 0; i < len && !has_conflict; ++i) {
+        if (lit_value(checker, lits[i]) == 1) {
+            has_conflict = true;
+        } else if (lit_value(checker, lits[i]) == 0) {
+            assign(checker, -lits[i]);
+        }
+    }
+    has_conflict = has_conflict || propagate(checker);
+    unassign_all(checker);
+    return has_conflict;
+}
+
+/**
+ * Checks, that every resolvent of the lemma on its first literal with a current clause is RUP.
+ * Resolvents are built after the lemma in the lemma buffer.
+ */
+static bool is_rat(Checker* checker, size_t len) {
+    if (len == 0) {
+        return false;
+    }
+    signed int pivot = checker->lemma[0];
+    for (size_t clause_num = 0; clause_num < checker->clauses_num; ++clause_num) {
+        const CheckClause* clause = &checker->clauses[clause_num];
+        if (clause->deleted) {
+            continue;
+        }
+        const signed int* lits = checker->lits + clause->offset;
+        bool has_pivot = false;
+        for (size_t i = 0; i < clause->len && !has_pivot; ++i) {
+            has_pivot = lits[i] == -pivot;
+        }
+        if (!has_pivot) {
+            continue;
+        }
+        reserve((void**) &checker->lemma, &checker->lemma_capacity, 2 * len + clause->len, sizeof(signed int));
+        signed int* resolvent = checker->lemma + len;
+        memcpy(resolvent, checker->lemma, len * sizeof(signed int));
+        size_t resolvent_len = len;
+        for (size_t i = 0; i < clause->len; ++i) {
+            if (lits[i] != -pivot) {
+                resolvent[resolvent_len++] = lits[i];
+            }
+        }
+        if (!is_rup(checker, resolvent, resolvent_len)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Returns the link to the not deleted clause with the same literals in the hash table, or NULL if there is none.
+ */
+static size_t* find_clause(Checker* checker, const signed int* lits, size_t len, uint64_t hash) {
+    for (size_t i = 0; i < len; ++i) {
+        checker->marks[cnf_lit_index(lits[i])] = true;
+    }
+    size_t* link = &checker->buckets[hash & (checker->buckets_num - 1)];
+    while (*link != NO_CLAUSE) {
+        const CheckClause* clause = &checker->clauses[*link];
+        if (clause->hash == hash && clause->len == len) {
+            const signed int* clause_lits = checker->lits + clause->offset;
+            bool is_same = true;
+            for (size_t i = 0; i < len && is_same; ++i) {
+                is_same = checker->marks[cnf_lit_index(clause_lits[i])];
+            }
+            if (is_same) {
+                break;
+            }
+        }
+        link = &checker->next_in_bucket[*link];
+    }
+    for (size_t i = 0; i < len; ++i) {
+        checker->marks[cnf_lit_index(lits[i])] = false;
+    }
+    return *link != NO_CLAUSE ? link : NULL;
+}
+
+static void rehash(Checker* checker) {
+    size_t buckets_num = checker->buckets_num == 0 ? 1024 : 2 * checker->buckets_num;
+    checker->buckets = (size_t*) checked_realloc(checker->buckets, buckets_num * sizeof(size_t));
+    checker->buckets_num = buckets_num;
+    for (size_t i = 0; i < buckets_num; ++i) {
+        checker->buckets[i] = NO_CLAUSE;
+    }
+    for (size_t clause_num = 0; clause_num < checker->clauses_num; ++clause_num) {
+        if (!checker->clauses[clause_num].deleted) {
+            size_t* bucket = &checker->buckets[checker->clauses[clause_num].hash & (buckets_num - 1)];
+            checker->next_in_bucket[clause_num] = *bucket;
+            *bucket = clause_num;
+        }
+    }
+}
+
+/**
+ * Removes duplicate literals in place and returns the new length.
+ */
+static size_t remove_duplicates(Checker* checker, signed int* lits, size_t len) {
+    size_t kept = 0;
+    for (size_t i = 0; i < len; ++i) {
+        if (!checker->marks[cnf_lit_index(lits[i])]) {
+            checker->marks[cnf_lit_index(lits[i])] = true;
+            lits[kept++] = lits[i];
+        }
+    }
+    for (size_t i = 0; i < kept; ++i) {
+        checker->marks[cnf_lit_index(lits[i])] = false;
+    }
+    return kept;
+}
+
+static void add_clause(Checker* checker, const signed int* lits, size_t len) {
+    if (len == 0) {
+        checker->has_empty_clause = true;
+        return;
+    }
+    size_t clause_num = checker->clauses_num;
+    reserve((void**) &checker->clauses, &checker->clauses_capacity, clause_num + 1, sizeof(CheckClause));
+    reserve((void**) &checker->next_in_bucket, &checker->next_in_bucket_capacity, clause_num + 1, sizeof(size_t));
+    reserve((void**) &checker->lits, &checker->lits_capacity, checker->lits_len + len, sizeof(signed int));
+
+    CheckClause* clause = &checker->clauses[clause_num];
+    clause->offset = checker->lits_len;
+    clause->len = len;
+    clause->hash = clause_hash(lits, len);
+    clause->deleted = false;
+    memcpy(checker->lits + checker->lits_len, lits, len * sizeof(signed int));
+    checker->lits_len += len;
+    ++checker->clauses_num;
+
+    if (checker->clauses_num > checker->buckets_num) {
+        rehash(checker);
+    } else {
+        size_t* bucket = &checker->buckets[clause->hash & (checker->buckets_num - 1)];
+        checker->next_in_bucket[clause_num] = *bucket;
+        *bucket = clause_num;
+    }
+    if (len == 1) {
+        clause_nums_push(&checker->units, clause_num);
+    } else {
+        clause_nums_push(&checker->watches[cnf_lit_index(lits[0])], clause_num);
+        clause_nums_push(&checker->watches[cnf_lit_index(lits[1])], clause_num);
+    }
+}
+
+static void delete_clause(Checker* checker, const signed int* lits, size_t len) {
+    ++checker->deletions_num;
+    if (len == 1) {
+        ++checker->ignored_deletions_num;
+        return;
+    }
+    size_t* link = find_clause(checker, lits, len, clause_hash(lits, len));
+    if (link == NULL) {
+        // Deletion only weakens the formula, so a missing clause does not make the proof wrong
+        ++checker->ignored_deletions_num;
+        return;
+    }
+    size_t clause_num = *link;
+    *link = checker->next_in_bucket[clause_num];
+    checker->clauses[clause_num].deleted = true;
+}
+
+/**
+ * Checks the lemma stored in the lemma buffer and adds it. Returns false if it is neither RUP nor RAT.
+ */
+static bool add_lemma(Checker* checker, size_t len) {
+    ++checker->lemmas_num;
+    len = remove_duplicates(checker, checker->lemma, len);
+    if (!is_rup(checker, checker->lemma, len)) {
+        if (!is_rat(checker, len)) {
+            return false;
+        }
+        ++checker->rat_lemmas_num;
+    }
+    add_clause(checker, checker->lemma, len);
+    return true;
+}
+
+static void push_lemma_lit(Checker* checker, size_t* len, signed int lit) {
+    size_t var = (size_t) (lit > 0 ? lit : -(long long) lit);
+    grow_vars(checker, var);
+    reserve((void**) &checker->lemma, &checker->lemma_capacity, *len + 1, sizeof(signed int));
+    checker->lemma[(*len)++] = lit;
+}
+
+static unsigned char* read_file(const char* path, size_t* len) {
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) {
+        fprintf(stderr, "Failed to open '%s'\n", path);
+        return NULL;
+    }
+    unsigned char* bytes = NULL;
+    size_t capacity = 0;
+    *len = 0;
+    while (true) {
+        reserve((void**) &bytes, &capacity, *len + (1 << 16), 1);
+        size_t read = fread(bytes + *len, 1, capacity - *len, fp);
+        *len += read;
+        if (read == 0) {
+            break;
+        }
+    }
+    bool has_error = ferror(fp) != 0;
+    fclose(fp);
+    if (has_error) {
+        fprintf(stderr, "Failed to read '%s'\n", path);
+        free(bytes);
+        return NULL;
+    }
+    return bytes;
+}
+
+/**
+ * Checks the proof until its empty clause. Returns the number of the first wrong lemma (counted from 1),
+ * 0 if all lemmas are right or SIZE_MAX if the proof is malformed.
+ */
+static size_t check_binary_proof(Checker* checker, const unsigned char* bytes, size_t bytes_len) {
+    size_t pos = 0;
+    while (pos < bytes_len && !checker->has_empty_clause) {
+        unsigned char kind = bytes[pos++];
+        if (kind != 'a' && kind != 'd') {
+            fprintf(stderr, "Unexpected byte 0x%02X at offset %zu\n", kind, pos - 1);
+            return SIZE_MAX;
+        }
+        size_t len = 0;
+        while (true) {
+            uint64_t value = 0;
+            unsigned int shift = 0;
+            do {
+                if (pos == bytes_len || shift > 28) {
+                    fprintf(stderr, "Truncated or too large literal at offset %zu\n", pos);
+                    return SIZE_MAX;
+                }
+                value |= (uint64_t) (bytes[pos] & 0x7F) << shift;
+                shift += 7;
+            } while (bytes[pos++] & 0x80);
+            if (value == 0) {
+                break;
+            }
+            if (value < 2 || (value >> 1) > (uint64_t) INT32_MAX) {
+                fprintf(stderr, "Literal out of range at offset %zu\n", pos);
+                return SIZE_MAX;
+            }
+            signed int var = (signed int) (value >> 1);
+            push_lemma_lit(checker, &len, (value & 1) != 0 ? -var : var);
+        }
+        if (kind == 'd') {
+            delete_clause(checker, checker->lemma, remove_duplicates(checker, checker->lemma, len));
+        } else if (!add_lemma(checker, len)) {
+            return checker->lemmas_num;
+        }
+    }
+    return 0;
+}
+
+static size_t check_text_proof(Checker* checker, const unsigned char* bytes, size_t bytes_len) {
+    size_t pos = 0;
+    while (!checker->has_empty_clause) {
+        while (pos < bytes_len && (bytes[pos] == ' ' || bytes[pos] == '\t' || bytes[pos] == '\r' || bytes[pos] == '\n')) {
+            ++pos;
+        }
+        if (pos == bytes_len) {
+            break;
+        }
+        if (bytes[pos] == 'c') {
+            while (pos < bytes_len && bytes[pos] != '\n') {
+                ++pos;
+            }
+            continue;
+        }
+        bool is_deletion = bytes[pos] == 'd';
+        if (is_deletion) {
+            ++pos;
+        }
+        size_t len = 0;
+        while (true) {
+            while (pos < bytes_len && (bytes[pos] == ' ' || bytes[pos] == '\t' || bytes[pos] == '\r' || bytes[pos] == '\n')) {
+                ++pos;
+            }
+            bool is_negative = pos < bytes_len && bytes[pos] == '-';
+            if (is_negative) {
+                ++pos;
+            }
+            if (pos == bytes_len || bytes[pos] < '0' || bytes[pos] > '9') {
+                fprintf(stderr, "Expected literal at offset %zu\n", pos);
+                return SIZE_MAX;
+            }
+            long long var = 0;
+            while (pos < bytes_len && bytes[pos] >= '0' && bytes[pos] <= '9' && var <= INT32_MAX) {
+                var = var * 10 + (bytes[pos++] - '0');
+            }
+            if (var > INT32_MAX) {
+                fprintf(stderr, "Literal out of range at offset %zu\n", pos);
+                return SIZE_MAX;
+            }
+            if (var == 0) {
+                break;
+            }
+            push_lemma_lit(checker, &len, is_negative ? -(signed int) var : (signed int) var);
+        }
+        if (is_deletion) {
+            delete_clause(checker, checker->lemma, remove_duplicates(checker, checker->lemma, len));
+        } else if (!add_lemma(checker, len)) {
+            return checker->lemmas_num;
+        }
+    }
+    return 0;
+}
+
+static void free_checker(Checker* checker) {
+    if (checker->watches != NULL) {
+        for (size_t i = 0; i < 2 * checker->vars_num; ++i) {
+            free(checker->watches[i].items);
+        }
+    }
+    free(checker->watches);
+    free(checker->units.items);
+    free(checker->clauses);
+    free(checker->lits);
+    free(checker->buckets);
+    free(checker->next_in_bucket);
+    free(checker->values);
+    free(checker->marks);
+    free(checker->trail);
+    free(checker->lemma);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s input.cnf proof.drat\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    FILE* fp = fopen(argv[1], "r");
+    if (fp == NULL) {
+        fprintf(stderr, "Failed to open '%s'\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    CNF* cnf = read_dimacs_cnf(fp);
+    fclose(fp);
+    if (cnf == NULL) {
+        fprintf(stderr, "Bad CNF syntax in file '%s'\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    size_t proof_len = 0;
+    unsigned char* proof = read_file(argv[2], &proof_len);
+    if (proof == NULL) {
+        free_cnf(cnf);
+        return EXIT_FAILURE;
+    }
+
+    Checker checker = {0};
+    grow_vars(&checker, cnf->vars_num);
+    rehash(&checker);
+    for (size_t i = 0; i < cnf->clauses_num; ++i) {
+        const Clause* clause = &cnf->clauses[i];
+        reserve((void**) &checker.lemma, &checker.lemma_capacity, clause->len, sizeof(signed int));
+        memcpy(checker.lemma, cnf_clause_vars(cnf, clause), clause->len * sizeof(signed int));
+        add_clause(&checker, checker.lemma, remove_duplicates(&checker, checker.lemma, clause->len));
+    }
+    free_cnf(cnf);
+
+    // Text proofs never contain zero bytes, while every binary lemma ends with one
+    bool is_binary = memchr(proof, 0, proof_len) != NULL;
+    size_t wrong_lemma = is_binary ? check_binary_proof(&checker, proof, proof_len) : check_text_proof(&checker, proof, proof_len);
+    free(proof);
+
+    int status = EXIT_FAILURE;
+    printf("c %s proof: %zu lemmas (%zu RAT), %zu deletions (%zu ignored)\n", is_binary ? "binary" : "text",
+           checker.lemmas_num, checker.rat_lemmas_num, checker.deletions_num, checker.ignored_deletions_num);
+    if (wrong_lemma == SIZE_MAX) {
+        printf("s NOT VERIFIED (malformed proof)\n");
+    } else if (wrong_lemma > 0) {
+        printf("s NOT VERIFIED (lemma %zu is neither RUP nor RAT)\n", wrong_lemma);
+    } else if (!checker.has_empty_clause && !is_rup(&checker, NULL, 0)) {
+        printf("s NOT VERIFIED (no empty clause)\n");
+    } else {
+        printf("s VERIFIED\n");
+        status = EXIT_SUCCESS;
+    }
+    free_checker(&checker);
+    return status;
+}
@@ -0,0 +1,6 @@
+#!/bin/bash
+
+cd $(dirname $0)
+for cnf_file in $(find ../unsat -type f \( -name "*.cnf" -o -name "*.cnf.gz" -o -name "*.cnf.xz" \)); do
+    ./run-single-test.sh $1 $2 $cnf_file "${@:3}";
+done
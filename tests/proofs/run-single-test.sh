@@ -0,0 +1,39 @@
+#!/bin/bash
+
+# Solves UNSAT CNF with proof in each format and checks the proof with the given DRAT checker.
+
+function success() {
+    echo "[ OK ]  ($1)"
+    exit 0
+}
+
+function failure() {
+    echo "[FAIL]: $1 ($2)"
+    exit 1
+}
+
+BINARY=$1
+CHECKER=$2
+CNF_FILE=$3
+PROOF_FILE=$(mktemp)
+trap "rm -f $PROOF_FILE" EXIT
+
+test -e $BINARY || failure "Binary doesn't exist at $BINARY" $3
+test -e $CHECKER || failure "Checker doesn't exist at $CHECKER" $3
+test -e $CNF_FILE || failure "CNF file doesn't exist at $CNF_FILE" $3
+
+for FORMAT in binary text; do
+    ACT_OUTPUT="$($BINARY "${@:4}" --proof=$PROOF_FILE --proof-format=$FORMAT $CNF_FILE)"
+    if [[ $? -ne 0 ]]; then
+        failure "Program terminated with non-zero exit code ($FORMAT proof)" $3
+    fi
+    if [[ $ACT_OUTPUT != 'UNSAT' ]]; then
+        failure "Expected 'UNSAT', but got '$ACT_OUTPUT' ($FORMAT proof)" $3
+    fi
+    CHECK_OUTPUT="$($CHECKER $CNF_FILE $PROOF_FILE)"
+    if [[ $? -ne 0 ]]; then
+        failure "Checker rejected $FORMAT proof: $(echo "$CHECK_OUTPUT" | tail -n 1)" $3
+    fi
+done
+
+success $3
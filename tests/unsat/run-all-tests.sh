@@ -1,7 +1,7 @@
 #!/bin/bash
 
 cd $(dirname $0)
-for cnf_file in $(find . -name "*.cnf" -type f); do
-    ./run-single-test.sh $1 $cnf_file;
+for cnf_file in $(find . -type f \( -name "*.cnf" -o -name "*.cnf.gz" -o -name "*.cnf.xz" \)); do
+    ./run-single-test.sh $1 $cnf_file "${@:2}";
 done
 
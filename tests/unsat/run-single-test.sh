@@ -15,7 +15,7 @@ CNF_FILE=$2
 test -e $1 || failure "Binary doesn't exist at $1" $2
 test -e $CNF_FILE || failure "CNF file doesn't exist at $CNF_FILE" $2
 
-ACT_OUTPUT="$($1 $CNF_FILE)"
+ACT_OUTPUT="$($1 "${@:3}" $CNF_FILE)"
 if [[ $? -ne 0 ]]; then
     failure "Program terminated with non-zero exit code" $2
 fi
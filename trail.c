@@ -0,0 +1,106 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "debug.h"
+#include "trail.h"
+#include "trivector.h"
+
+Trail* create_trail(size_t vars_num) {
+    Trail* trail = (Trail*) calloc(1, sizeof(Trail));
+    if (trail == NULL) {
+        fprintf(stderr, "Trail Error: Insufficient memory\n");
+        return NULL;
+    }
+
+    trail->vars_states = create_trivector(vars_num);
+    trail->lit_values = (unsigned char*) calloc(2 * vars_num + 2, sizeof(unsigned char));
+    trail->vars = (signed int*) calloc(vars_num + 1, sizeof(signed int));
+    trail->level_starts = (size_t*) calloc(vars_num + 1, sizeof(size_t));
+    trail->levels = (size_t*) calloc(vars_num + 1, sizeof(size_t));
+    trail->levels_capacity = vars_num;
+    if (trail->vars_states == NULL || trail->lit_values == NULL || trail->vars == NULL || trail->level_starts == NULL || trail->levels == NULL) {
+        fprintf(stderr, "Trail Error: Insufficient memory\n");
+        free_trail(trail);
+        return NULL;
+    }
+    return trail;
+}
+
+void free_trail(Trail* trail) {
+    if (trail != NULL) {
+        free_trivector(trail->vars_states);
+        free(trail->lit_values);
+        free(trail->vars);
+        free(trail->level_starts);
+        free(trail->levels);
+        free(trail);
+    }
+}
+
+int trail_grow(Trail* trail, size_t vars_num) {
+    assert(trail != NULL);
+    assert(vars_num >= trail->vars_states->len);
+
+    size_t old_vars_num = trail->vars_states->len;
+    unsigned char* lit_values = (unsigned char*) realloc(trail->lit_values, (2 * vars_num + 2) * sizeof(unsigned char));
+    if (lit_values != NULL) {
+        memset(lit_values + 2 * old_vars_num + 2, LIT_UNSET, 2 * (vars_num - old_vars_num) * sizeof(unsigned char));
+        trail->lit_values = lit_values;
+    }
+    signed int* vars = (signed int*) realloc(trail->vars, (vars_num + 1) * sizeof(signed int));
+    if (vars != NULL) {
+        trail->vars = vars;
+    }
+    size_t* levels = (size_t*) realloc(trail->levels, (vars_num + 1) * sizeof(size_t));
+    if (levels != NULL) {
+        trail->levels = levels;
+    }
+    if (lit_values == NULL || vars == NULL || levels == NULL || trivector_grow(trail->vars_states, vars_num) != 0) {
+        fprintf(stderr, "Trail Error: Insufficient memory\n");
+        return -1;
+    }
+    return trail_reserve_levels(trail, vars_num);
+}
+
+int trail_reserve_levels(Trail* trail, size_t levels_num) {
+    assert(trail != NULL);
+
+    if (levels_num <= trail->levels_capacity) {
+        return 0;
+    }
+    size_t* level_starts = (size_t*) realloc(trail->level_starts, (levels_num + 1) * sizeof(size_t));
+    if (level_starts == NULL) {
+        fprintf(stderr, "Trail Error: Insufficient memory\n");
+        return -1;
+    }
+    trail->level_starts = level_starts;
+    trail->levels_capacity = levels_num;
+    return 0;
+}
+
+void trail_backtrack(Trail* trail, size_t level) {
+    assert(trail != NULL);
+    assert(level <= trail->levels_num);
+
+    if (level == trail->levels_num) {
+        return;
+    }
+
+    size_t new_len = trail->level_starts[level];
+    TriVector* vars_states = trail->vars_states;
+    unsigned char* lit_values = trail->lit_values;
+    signed int* vars = trail->vars;
+    for (size_t i = new_len, len = trail->len; i < len; ++i) {
+        trivector_unset(vars_states, trail_var_index(vars[i]));
+        size_t lit_index = trail_lit_index(vars[i]);
+        lit_values[lit_index] = LIT_UNSET;
+        lit_values[lit_index ^ 1] = LIT_UNSET;
+    }
+    trail->len = new_len;
+    if (trail->propagated > new_len) {
+        trail->propagated = new_len;
+    }
+    trail->levels_num = level;
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "debug.h"
+#include "trivector.h"
+
+/**
+ * Value of a literal in Trail::lit_values.
+ */
+typedef enum LitValue {
+    LIT_UNSET = 0,
+    LIT_TRUE = 1,
+    LIT_FALSE = 2,
+} LitValue;
+
+/**
+ * Assignment trail: vars in the order they were assigned, split into decision levels.
+ * Level 0 contains vars assigned before the first decision, level i starts with i-th decision var.
+ */
+typedef struct Trail {
+    TriVector* vars_states;
+    unsigned char* lit_values; // LitValue of each literal, indexed by trail_lit_index (a var and its negation are neighbours)
+    signed int* vars;
+    size_t len;
+    size_t propagated;    // vars[0..propagated) were already propagated
+    size_t* level_starts; // Index in vars of the first var of each level (except level 0)
+    size_t levels_num;    // Current decision level
+    size_t levels_capacity; // Levels without vars (already true assumptions) may make it more than number of vars
+    size_t* levels;       // Decision level of each assigned var
+} Trail;
+
+Trail* create_trail(size_t vars_num);
+
+void free_trail(Trail* trail);
+
+/**
+ * Makes room for vars up to vars_num, keeping the current assignment. Returns -1 if out of memory.
+ */
+int trail_grow(Trail* trail, size_t vars_num);
+
+/**
+ * Makes room for levels up to levels_num. Returns -1 if out of memory.
+ */
+int trail_reserve_levels(Trail* trail, size_t levels_num);
+
+static inline size_t trail_var_index(signed int var) {
+    assert(var != 0);
+    return (var > 0 ? var : -var) - 1;
+}
+
+/**
+ * Same numbering as cnf_lit_index, but the sign is taken from the sign bit instead of a branch.
+ */
+static inline size_t trail_lit_index(signed int var) {
+    assert(var != 0);
+    return 2 * trail_var_index(var) + ((unsigned int) var >> (sizeof(signed int) * CHAR_BIT - 1));
+}
+
+static inline void trail_assign(Trail* trail, signed int var) {
+    assert(trail != NULL);
+    assert(var != 0);
+    assertf(trail->len < trail->vars_states->len, "Trail overflow: %zu >= %zu", trail->len, trail->vars_states->len);
+
+    size_t index = trail_var_index(var);
+    trivector_set(trail->vars_states, index);
+    size_t lit_index = trail_lit_index(var);
+    trail->lit_values[lit_index] = LIT_TRUE;
+    trail->lit_values[lit_index ^ 1] = LIT_FALSE;
+    trail->levels[index] = trail->levels_num;
+    trail->vars[trail->len++] = var;
+}
+
+static inline void trail_new_level(Trail* trail) {
+    assert(trail != NULL);
+    assertf(trail->levels_num < trail->levels_capacity, "Too many levels: %zu >= %zu", trail->levels_num, trail->levels_capacity);
+
+    trail->level_starts[trail->levels_num++] = trail->len;
+}
+
+static inline size_t trail_level_of(const Trail* trail, signed int var) {
+    assert(trail != NULL);
+    assert(!trivector_is_not_set(trail->vars_states, trail_var_index(var)));
+
+    return trail->levels[trail_var_index(var)];
+}
+
+/**
+ * Unassigns all vars of levels above the given one.
+ */
+void trail_backtrack(Trail* trail, size_t level);
@@ -1,11 +1,24 @@
 #include <assert.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include "debug.h"
 #include "trivector.h"
 
+#if defined(__x86_64__) || defined(__i386__)
+#define TRIVECTOR_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * Words of the bitmap for the given number of items, which leaves at least one padding bit after them.
+ */
+static size_t words_num_for(size_t len) {
+    return (len / (64 * TRIVECTOR_BLOCK_WORDS) + 1) * TRIVECTOR_BLOCK_WORDS;
+}
+
 TriVector* create_trivector(size_t len) {
     TriVector* tv = (TriVector*) calloc(1, sizeof(TriVector));
     if (tv == NULL) {
@@ -14,47 +27,99 @@ TriVector* create_trivector(size_t len) {
     }
 
     tv->len = len;
-    tv->states = (TriVectorState*) calloc(len, sizeof(TriVectorState));
-    if (tv->states == NULL) {
+    tv->words_num = words_num_for(len);
+    tv->assigned = (uint64_t*) calloc(tv->words_num, sizeof(uint64_t));
+    if (tv->assigned == NULL) {
         fprintf(stderr, "Tri Vector Error: Insufficient memory\n");
-        free(tv);
+        free_trivector(tv);
         return NULL;
     }
     return tv;
 }
 
-TriVector* clone_trivector(const TriVector* origin) {
-    assert(origin != NULL);
+void free_trivector(TriVector* tv) {
+    if (tv != NULL) {
+        free(tv->assigned);
+        free(tv);
+    }
+}
 
-    size_t len = origin->len;
-    TriVector* clone = create_trivector(len);
-    if (clone == NULL) {
-        fprintf(stderr, "Tri Vector Error: Insufficient memory\n");
-        return NULL;
+int trivector_grow(TriVector* tv, size_t len) {
+    assert(tv != NULL);
+    assert(len >= tv->len);
+
+    size_t words_num = words_num_for(len);
+    if (words_num > tv->words_num) {
+        uint64_t* assigned = (uint64_t*) realloc(tv->assigned, words_num * sizeof(uint64_t));
+        if (assigned == NULL) {
+            fprintf(stderr, "Tri Vector Error: Insufficient memory\n");
+            return -1;
+        }
+        tv->assigned = assigned;
+        // Padding bits are never set, so only new words are cleared
+        memset(tv->assigned + tv->words_num, 0, (words_num - tv->words_num) * sizeof(uint64_t));
+        tv->words_num = words_num;
+    }
+    tv->len = len;
+    return 0;
+}
+
+static size_t index_of_zero_bit_scalar(const uint64_t* words, size_t first_word, size_t words_num) {
+    for (size_t i = first_word; i < words_num; ++i) {
+        if (words[i] != UINT64_MAX) {
+            return 64 * i + (size_t) __builtin_ctzll(~words[i]);
+        }
     }
+    return 64 * words_num;
+}
+
+#ifdef TRIVECTOR_X86
 
-    clone->len = len;
-    memcpy(clone->states, origin->states, len * sizeof(TriVectorState));
-    return clone;
+/**
+ * Skips blocks without zero bits 256 bits at a time, the first one is found by scalar code.
+ */
+__attribute__((target("avx2")))
+static size_t index_of_zero_bit_avx2(const uint64_t* words, size_t words_num) {
+    const __m256i ones = _mm256_set1_epi64x(-1);
+    size_t i = 0;
+    for (; i < words_num; i += 4) {
+        __m256i block = _mm256_loadu_si256((const __m256i*) (words + i));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi64(block, ones)) != -1) {
+            break;
+        }
+    }
+    return index_of_zero_bit_scalar(words, i, words_num);
 }
 
-void free_trivector(TriVector* tv) {
-    if (tv != NULL) {
-        free(tv->states);
-        free(tv);
+__attribute__((target("sse2")))
+static size_t index_of_zero_bit_sse2(const uint64_t* words, size_t words_num) {
+    const __m128i ones = _mm_set1_epi32(-1);
+    size_t i = 0;
+    for (; i < words_num; i += 2) {
+        __m128i block = _mm_loadu_si128((const __m128i*) (words + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(block, ones)) != 0xFFFF) {
+            break;
+        }
     }
+    return index_of_zero_bit_scalar(words, i, words_num);
 }
 
+#endif
+
 size_t trivector_index_of_not_set(const TriVector* tv) {
     assert(tv != NULL);
 
-    size_t len = tv->len;
-    TriVectorState* states = tv->states;
-    for (size_t i = 0; i < len; ++i) {
-        if (states[i] == NOT_SET) {
-            return i;
-        }
+    size_t index = 0;
+#ifdef TRIVECTOR_X86
+    if (__builtin_cpu_supports("avx2")) {
+        index = index_of_zero_bit_avx2(tv->assigned, tv->words_num);
+    } else if (__builtin_cpu_supports("sse2")) {
+        index = index_of_zero_bit_sse2(tv->assigned, tv->words_num);
+    } else
+#endif
+    {
+        index = index_of_zero_bit_scalar(tv->assigned, 0, tv->words_num);
     }
-    return len;
+    // Padding bits are never set, so they are found after the last item
+    return index < tv->len ? index : tv->len;
 }
-
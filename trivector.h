@@ -1,51 +1,52 @@
 #pragma once
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
-typedef enum {
-    NOT_SET,
-    SET_TRUE,
-    SET_FALSE,
-} __attribute__((__packed__)) TriVectorState;
+#define TRIVECTOR_BLOCK_WORDS 4 // Bitmap is padded to whole 256-bit blocks, so SIMD scans need no tail loop
 
+/**
+ * Vector of items, that are either set or not set, stored as a bitmap with a bit per set item.
+ * Values of set items are kept by the owner (see Trail::lit_values), which reads them far more often,
+ * while the bitmap serves scans for items, that are not set.
+ */
 typedef struct TriVector {
     size_t len;
-    TriVectorState* states;
+    size_t words_num;   // Multiple of TRIVECTOR_BLOCK_WORDS
+    uint64_t* assigned; // Bit i is set, if item i is set
 } TriVector;
 
 TriVector* create_trivector(size_t len);
 
-TriVector* clone_trivector(const TriVector* origin);
-
 void free_trivector(TriVector* tv);
 
-static inline void trivector_set(TriVector* tv, size_t index, bool is_true) {
-    assert(tv != NULL);
-    assertf(index < tv->len, "Expected size in [0; %lu), but got %lu", tv->len, index);
-
-    tv->states[index] = is_true ? SET_TRUE : SET_FALSE;
-}
+/**
+ * Grows the vector up to len items, new items are not set. Returns -1 if out of memory.
+ */
+int trivector_grow(TriVector* tv, size_t len);
 
-static inline bool trivector_is_set_true(const TriVector* tv, size_t index) {
+static inline void trivector_set(TriVector* tv, size_t index) {
     assert(tv != NULL);
     assertf(index < tv->len, "Expected size in [0; %lu), but got %lu", tv->len, index);
 
-    return tv->states[index] == SET_TRUE;
+    tv->assigned[index >> 6] |= (uint64_t) 1 << (index & 63);
 }
 
-static inline bool trivector_is_set_false(const TriVector* tv, size_t index) {
+static inline void trivector_unset(TriVector* tv, size_t index) {
     assert(tv != NULL);
     assertf(index < tv->len, "Expected size in [0; %lu), but got %lu", tv->len, index);
 
-    return tv->states[index] == SET_FALSE;
+    tv->assigned[index >> 6] &= ~((uint64_t) 1 << (index & 63));
 }
 
 static inline bool trivector_is_not_set(const TriVector* tv, size_t index) {
     assert(tv != NULL);
     assertf(index < tv->len, "Expected size in [0; %lu), but got %lu", tv->len, index);
 
-    return tv->states[index] == NOT_SET;
+    return !((tv->assigned[index >> 6] >> (index & 63)) & 1);
 }
 
+/**
+ * Returns index of the first item, that is not set, or len if every item is set.
+ */
 size_t trivector_index_of_not_set(const TriVector* tv);
-